@@ -3,6 +3,12 @@
 #include "glad/glad.h"
 #include <GL/gl.h>
 #include <iostream>
+#include "app/Window.hpp"
+#include "app/Redraw.hpp"
+#include "app/FramePacer.hpp"
+#include "app/FrameCapture.hpp"
+#include "app/InputRecorder.hpp"
+#include "profiling/Profiler.hpp"
 
 /* Minimal time wanted between two images */
 static const double FRAMERATE_IN_SECONDS = 1. / 30.;
@@ -13,8 +19,10 @@ void onError(int error, const char *description)
 	std::cout << "GLFW Error (" << error << ") : " << description << std::endl;
 }
 
-int main()
+int main(int argc, char **argv)
 {
+	AppOptions options = parseOptions(argc, argv);
+
 	// Initialize the library
 	if (!glfwInit())
 	{
@@ -24,15 +32,8 @@ int main()
 	/* Callback to a function if an error is rised by GLFW */
 	glfwSetErrorCallback(onError);
 
-	// Create a windowed mode window and its OpenGL context
-#ifdef __APPLE__
-	// We need to explicitly ask for a 3.3 context on Mac
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-#endif
-	GLFWwindow *window = glfwCreateWindow(1280, 720, "OpenGLTemplate", nullptr, nullptr);
+	// Create a windowed mode window (hidden when headless) and its OpenGL context
+	GLFWwindow *window = createWindow(options, 1280, 720, "OpenGLTemplate");
 	if (!window)
 	{
 		glfwTerminate();
@@ -48,20 +49,59 @@ int main()
 		return -1;
 	}
 
+	/* Frame rate limit, vsync or uncapped depending on the options */
+	FramePacer pacer(options, FRAMERATE_IN_SECONDS);
+
+	/* Headless : draw into an offscreen framebuffer instead of the window */
+	OffscreenTarget offscreen;
+	if (options.headless)
+	{
+		offscreen.create(1280, 720);
+	}
+
+	/* --capture : frames are read back without stalling and written as PNG in the background */
+	FrameCapture capture;
+	if (!options.capturePrefix.empty())
+	{
+		capture.start(options.capturePrefix);
+	}
+
 	/*
 	glfwSetKeyCallback(window, [](GLFWwindow* window, int key, int scancode, int action, int mods) {
 		std::cout << "key pressed: " << key << ", " << scancode << std::endl;
 	});
 	*/
 
+	installRedrawCallbacks(window);
+
+	/* --record / --replay, once every input callback is set ; the loop is
+	   skipped if the file cannot be opened */
+	if (!installInputRecorder(window, options))
+	{
+		glfwSetWindowShouldClose(window, GLFW_TRUE);
+	}
+
 	/* Loop until the user closes the window */
-	while (!glfwWindowShouldClose(window))
+	int frame = 0;
+	while (!glfwWindowShouldClose(window) && !options.finished(frame))
 	{
-		/* Get time (in second) at loop beginning */
-		double startTime = glfwGetTime();
+		/* Sleep while minimized, or until something changed in on-demand mode */
+		if (waitForRedraw(window, options.onDemand))
+		{
+			pacer.restart();
+		}
+		if (glfwWindowShouldClose(window))
+		{
+			break;
+		}
+
+		PROFILE_ZONE("frame");
 
 		/* Render here */
-		glClear(GL_COLOR_BUFFER_BIT);
+		{
+			PROFILE_ZONE("clear");
+			glClear(GL_COLOR_BUFFER_BIT);
+		}
 
 		// render exemple quad
 		glColor3f(1.0f, 0.0f, 0.0f);
@@ -72,21 +112,36 @@ int main()
 		glVertex2f(-1.0f, 1.0f);
 		glEnd();
 
+		/* Queue the read-back of this frame (--capture) */
+		capture.capture();
+
 		/* Swap front and back buffers */
-		glfwSwapBuffers(window);
+		{
+			PROFILE_ZONE("glfwSwapBuffers");
+			glfwSwapBuffers(window);
+		}
+		frame++;
+		frameDrawn();
+		inputFrame(window, frame);
 
 		/* Poll for and process events */
-		glfwPollEvents();
+		{
+			PROFILE_ZONE("glfwPollEvents");
+			glfwPollEvents();
+		}
 
-		/* Elapsed time computation from loop begining */
-		double elapsedTime = glfwGetTime() - startTime;
-		/* If to few time is spend vs our wanted FPS, we wait */
-		if (elapsedTime < FRAMERATE_IN_SECONDS)
+		/* Wait for the next frame deadline (vsync already waited in glfwSwapBuffers) */
 		{
-			glfwWaitEventsTimeout(FRAMERATE_IN_SECONDS - elapsedTime);
+			PROFILE_ZONE("wait");
+			pacer.endFrame();
 		}
 	}
 
+	stopInputRecorder();
+	capture.stop();
+	pacer.report();
+	PROFILE_EXPORT(options.profileOutput.c_str());
+	offscreen.release();
 	glfwTerminate();
 	return 0;
 }
\ No newline at end of file
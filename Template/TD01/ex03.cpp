@@ -3,10 +3,18 @@
 #include "glad/glad.h"
 #include <GL/gl.h>
 #include <iostream>
+#include "app/Window.hpp"
+#include "app/Redraw.hpp"
+#include "app/FramePacer.hpp"
+#include "app/FrameCapture.hpp"
+#include "app/InputRecorder.hpp"
+#include "profiling/Profiler.hpp"
+#include "render/Camera2D.hpp"
 
 /* Space of the virtual window*/
 static const float GL_VIEW_SIZE = 1;
-static float aspectRatio;
+/* Projection of the GL_VIEW_SIZE framing */
+static Camera2D camera(GL_VIEW_SIZE);
 static int window_width = 0;
 static int window_height = 0;
 static bool mode = 0;
@@ -23,26 +31,14 @@ void onError(int error, const char *description)
 
 void onWindowResized(GLFWwindow *window, int width, int height)
 {
-	aspectRatio = width / (float)height;
+	requestRedraw();
 	glViewport(0, 0, width, height);
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	if (aspectRatio > 1)
-	{
-		glOrtho(
-			-GL_VIEW_SIZE / 2. * aspectRatio, GL_VIEW_SIZE / 2. * aspectRatio,
-			-GL_VIEW_SIZE / 2., GL_VIEW_SIZE / 2., -1.0, 1.0);
-	}
-	else
-	{
-		glOrtho(
-			-GL_VIEW_SIZE / 2., GL_VIEW_SIZE / 2.,
-			-GL_VIEW_SIZE / 2. / aspectRatio, GL_VIEW_SIZE / 2. / aspectRatio, -1.0, 1.0);
-	}
+	camera.setViewport(width, height);
 }
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods)
 {
+	requestRedraw();
 	if (key == GLFW_KEY_Q && action == GLFW_PRESS)
 	{
 		glfwSetWindowShouldClose(window, GLFW_TRUE);
@@ -57,11 +53,12 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
 {
+	requestRedraw();
 	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
 	{
 		double xpos, ypos;
-		glfwGetCursorPos(window, &xpos, &ypos);
-		glfwGetWindowSize(window, &window_width, &window_height);
+		inputCursorPos(window, &xpos, &ypos);
+		inputWindowSize(window, &window_width, &window_height);
 		glClearColor(float(xpos) / window_width, 0.0f, float(ypos) / window_height, 1.0f);
 	}
 }
@@ -70,13 +67,15 @@ static void cursor_pos_callback(GLFWwindow *window, double xpos, double ypos)
 {
 	if (mode)
 	{
-		glfwGetWindowSize(window, &window_width, &window_height);
+		requestRedraw();
+		inputWindowSize(window, &window_width, &window_height);
 		glClearColor(float(xpos) / window_width, 0.0f, float(ypos) / window_height, 1.0f);
 	}
 }
 
 static void add_red_callback(GLFWwindow *window, int key, int scancode, int action, int mods)
 {
+	requestRedraw();
 	if (!mode)
 	{
 		if (key == GLFW_KEY_R && action == GLFW_PRESS && red <= 1)
@@ -87,8 +86,10 @@ static void add_red_callback(GLFWwindow *window, int key, int scancode, int acti
 	}
 }
 
-int main()
+int main(int argc, char **argv)
 {
+	AppOptions options = parseOptions(argc, argv);
+
 	// Initialize the library
 	if (!glfwInit())
 	{
@@ -98,15 +99,8 @@ int main()
 	/* Callback to a function if an error is rised by GLFW */
 	glfwSetErrorCallback(onError);
 
-	// Create a windowed mode window and its OpenGL context
-#ifdef __APPLE__
-	// We need to explicitly ask for a 3.3 context on Mac
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-#endif
-	GLFWwindow *window = glfwCreateWindow(800, 800, "TD 01 Ex 03", nullptr, nullptr);
+	// Create a windowed mode window (hidden when headless) and its OpenGL context
+	GLFWwindow *window = createWindow(options, 800, 800, "TD 01 Ex 03");
 
 	if (!window)
 	{
@@ -123,6 +117,23 @@ int main()
 		return -1;
 	}
 
+	/* Frame rate limit, vsync or uncapped depending on the options */
+	FramePacer pacer(options, FRAMERATE_IN_SECONDS);
+
+	/* Headless : draw into an offscreen framebuffer instead of the window */
+	OffscreenTarget offscreen;
+	if (options.headless)
+	{
+		offscreen.create(800, 800);
+	}
+
+	/* --capture : frames are read back without stalling and written as PNG in the background */
+	FrameCapture capture;
+	if (!options.capturePrefix.empty())
+	{
+		capture.start(options.capturePrefix);
+	}
+
 	onWindowResized(window, 800, 800);
 	glfwSetWindowSizeCallback(window, onWindowResized);
 
@@ -135,30 +146,70 @@ int main()
 	glfwSetCursorPosCallback(window, cursor_pos_callback);
 	glfwSetKeyCallback(window, add_red_callback);
 
+	installRedrawCallbacks(window);
+
+	/* --record / --replay, once every input callback is set ; the loop is
+	   skipped if the file cannot be opened */
+	if (!installInputRecorder(window, options))
+	{
+		glfwSetWindowShouldClose(window, GLFW_TRUE);
+	}
+
 	/* Loop until the user closes the window */
-	while (!glfwWindowShouldClose(window))
+	int frame = 0;
+	while (!glfwWindowShouldClose(window) && !options.finished(frame))
 	{
-		/* Get time (in second) at loop beginning */
-		double startTime = glfwGetTime();
+		/* Sleep while minimized, or until something changed in on-demand mode */
+		if (waitForRedraw(window, options.onDemand))
+		{
+			pacer.restart();
+		}
+		if (glfwWindowShouldClose(window))
+		{
+			break;
+		}
+
+		PROFILE_ZONE("frame");
+
+		/* Reloads the projection after a resize */
+		camera.apply();
 
 		/* Render here */
-		glClear(GL_COLOR_BUFFER_BIT);
+		{
+			PROFILE_ZONE("clear");
+			glClear(GL_COLOR_BUFFER_BIT);
+		}
+
+		/* Queue the read-back of this frame (--capture) */
+		capture.capture();
 
 		/* Swap front and back buffers */
-		glfwSwapBuffers(window);
+		{
+			PROFILE_ZONE("glfwSwapBuffers");
+			glfwSwapBuffers(window);
+		}
+		frame++;
+		frameDrawn();
+		inputFrame(window, frame);
 
 		/* Poll for and process events */
-		glfwPollEvents();
+		{
+			PROFILE_ZONE("glfwPollEvents");
+			glfwPollEvents();
+		}
 
-		/* Elapsed time computation from loop begining */
-		double elapsedTime = glfwGetTime() - startTime;
-		/* If to few time is spend vs our wanted FPS, we wait */
-		if (elapsedTime < FRAMERATE_IN_SECONDS)
+		/* Wait for the next frame deadline (vsync already waited in glfwSwapBuffers) */
 		{
-			glfwWaitEventsTimeout(FRAMERATE_IN_SECONDS - elapsedTime);
+			PROFILE_ZONE("wait");
+			pacer.endFrame();
 		}
 	}
 
+	stopInputRecorder();
+	capture.stop();
+	pacer.report();
+	PROFILE_EXPORT(options.profileOutput.c_str());
+	offscreen.release();
 	glfwTerminate();
 	return 0;
 }
\ No newline at end of file
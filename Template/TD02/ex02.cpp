@@ -4,13 +4,28 @@
 #include <GL/gl.h>
 #include <vector>
 #include <iostream>
+#include "app/Window.hpp"
+#include "app/Redraw.hpp"
+#include "app/FramePacer.hpp"
+#include "app/FrameCapture.hpp"
+#include "app/InputRecorder.hpp"
+#include "profiling/Profiler.hpp"
+#include "render/Camera2D.hpp"
+#include "render/Vertex.hpp"
+#include "render/VertexBuffer.hpp"
+#include "geometry/Triangulator.hpp"
+#include "render/View.hpp"
+#include "pointcloud/PointCloud.hpp"
+#include "spatial/VertexGrid.hpp"
+#include "spatial/ChunkedBounds.hpp"
 
 /* Minimal time wanted between two images */
 static const float GL_VIEW_SIZE = 2;
-static float aspectRatio;
 static const double FRAMERATE_IN_SECONDS = 1. / 30.;
 static int window_width = 800;
 static int window_height = 800;
+/* Pan (middle button) and zoom (wheel) on top of the GL_VIEW_SIZE framing */
+static Camera2D camera(GL_VIEW_SIZE);
 enum Primitives
 {
 	Triangle,
@@ -21,13 +36,25 @@ enum Primitives
 };
 static Primitives primitive;
 
-struct Vertex
-{
-	double posX;
-	double posY;
-};
-
 std::vector<Vertex> vectex{};
+/* Clicked vertices stay in floats on the GPU : one 16-bit frame over every
+   click would move the points by pixels once zoomed in, away from picking */
+static VertexBuffer<VertexF32> vertexBuffer;
+/* Boxes of slices of vectex : drawPrimitive skips those outside the view */
+static ChunkedBounds vertexBounds;
+static std::vector<VertexRange> visibleVertices;
+/* Polygone draws the ear-clipping triangulation of vectex */
+static Triangulator polygon;
+static IndexBuffer polygonIndices;
+/* First vertex of each hole, H starts a new one */
+static std::vector<size_t> holeStarts;
+/* Spatial index over vectex : hover, Shift+click snapping, right-drag moving */
+static VertexGrid vertexGrid;
+static uint32_t hoveredVertex = VertexGrid::NO_VERTEX;
+static uint32_t draggedVertex = VertexGrid::NO_VERTEX;
+static const float PICK_RADIUS_IN_PIXELS = 8;
+/* Optional streamed point cloud (--points), shown with the Point primitive */
+static PointCloud pointCloud;
 
 /* Error handling function */
 void onError(int error, const char *description)
@@ -37,57 +64,58 @@ void onError(int error, const char *description)
 
 void drawPrimitive(Primitives prim)
 {
+	PROFILE_ZONE("drawPrimitive");
 	glPointSize(10);
+	/* Points are 10 pixels wide : their centers may be up to 5 pixels outside */
+	const View &view = camera.view();
+	vertexBounds.visibleRanges(view.bounds.expanded(5 / view.pixelsPerUnit), visibleVertices);
 	switch (prim)
 	{
 	case Primitives::Triangle:
-		glBegin(GL_TRIANGLES);
+		vertexBuffer.draw(GL_TRIANGLES, visibleVertices);
 		break;
 	case Primitives::Quad:
-		glBegin(GL_QUADS);
+		vertexBuffer.draw(GL_QUADS, visibleVertices);
 		break;
 	case Primitives::Line:
-		glBegin(GL_LINES);
+		vertexBuffer.draw(GL_LINES, visibleVertices);
 		break;
 	case Primitives::Point:
-		glBegin(GL_POINTS);
+		pointCloud.draw(camera.view(), 1);
+		if (pointCloud.streaming())
+		{
+			requestRedraw();
+		}
+		glPointSize(10);
+		vertexBuffer.draw(GL_POINTS, visibleVertices);
 		break;
 	case Primitives::Polygone:
-		glBegin(GL_POLYGON);
+		vertexBuffer.draw(GL_TRIANGLES, polygonIndices);
 		break;
 	}
 
-	for (Vertex v : vectex)
+	if (hoveredVertex != VertexGrid::NO_VERTEX)
 	{
-		glVertex2d(v.posX, v.posY);
+		glPushAttrib(GL_CURRENT_BIT | GL_POINT_BIT);
+		glPointSize(16);
+		glColor3f(1, 0.5, 0);
+		vertexBuffer.draw(GL_POINTS, hoveredVertex, 1);
+		glPopAttrib();
 	}
-	glEnd();
 }
 
 void onWindowResized(GLFWwindow *window, int width, int height)
 {
-	aspectRatio = width / (float)height;
+	requestRedraw();
 	window_width = width;
 	window_height = height;
 	glViewport(0, 0, width, height);
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	if (aspectRatio > 1)
-	{
-		glOrtho(
-			-GL_VIEW_SIZE / 2. * aspectRatio, GL_VIEW_SIZE / 2. * aspectRatio,
-			-GL_VIEW_SIZE / 2., GL_VIEW_SIZE / 2., -1.0, 1.0);
-	}
-	else
-	{
-		glOrtho(
-			-GL_VIEW_SIZE / 2., GL_VIEW_SIZE / 2.,
-			-GL_VIEW_SIZE / 2. / aspectRatio, GL_VIEW_SIZE / 2. / aspectRatio, -1.0, 1.0);
-	}
+	camera.setViewport(width, height);
 }
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods)
 {
+	requestRedraw();
 	if (key == GLFW_KEY_1 && action == GLFW_PRESS)
 		primitive = Primitives::Point;
 
@@ -99,32 +127,89 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 
 	else if (key == GLFW_KEY_4 && action == GLFW_PRESS)
 		primitive = Primitives::Polygone;
+
+	else if (key == GLFW_KEY_H && action == GLFW_PRESS && !vectex.empty() &&
+			 (holeStarts.empty() || holeStarts.back() < vectex.size()))
+		holeStarts.push_back(vectex.size());
 }
 
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
 {
+	requestRedraw();
+	double xpos, ypos;
+	inputCursorPos(window, &xpos, &ypos);
+	if (camera.mouseButton(button, action, xpos, ypos))
+	{
+		return;
+	}
+
 	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
 	{
-		double xpos, ypos;
-		glfwGetCursorPos(window, &xpos, &ypos);
-		if (aspectRatio >= 1)
-		{
-			xpos = aspectRatio * (xpos * (double(2) / window_width) - 1);
-			ypos = -ypos * (double(2) / window_height) + 1;
-		}
-		else
+		camera.toWorld(xpos, ypos);
+
+		Vertex v{float(xpos), float(ypos)};
+		if ((mods & GLFW_MOD_SHIFT) && hoveredVertex != VertexGrid::NO_VERTEX)
 		{
-			xpos = xpos * (double(2) / window_width) - 1;
-			ypos = 1 / aspectRatio * (-ypos * (double(2) / window_height) + 1);
+			/* Snap onto the vertex under the cursor */
+			v = vectex[hoveredVertex];
 		}
-
-		Vertex v{xpos, ypos};
 		vectex.push_back(v);
+		vertexGrid.insert(v.posX, v.posY);
+		vertexBuffer.sync(vectex);
+		vertexBounds.sync(vectex);
+		polygon.update(vectex, holeStarts);
+		polygonIndices.sync(polygon.indices(), polygon.firstChanged());
+	}
+	else if (button == GLFW_MOUSE_BUTTON_RIGHT)
+	{
+		draggedVertex = action == GLFW_PRESS ? hoveredVertex : VertexGrid::NO_VERTEX;
 	}
 }
 
-int main()
+void cursor_position_callback(GLFWwindow *window, double xpos, double ypos)
 {
+	(void)window;
+	if (camera.cursorMoved(xpos, ypos))
+	{
+		requestRedraw();
+		return;
+	}
+
+	camera.toWorld(xpos, ypos);
+	if (draggedVertex != VertexGrid::NO_VERTEX)
+	{
+		vectex[draggedVertex] = Vertex{float(xpos), float(ypos)};
+		vertexGrid.move(draggedVertex, float(xpos), float(ypos));
+		vertexBuffer.update(vectex, draggedVertex);
+		vertexBounds.update(vectex, draggedVertex);
+		polygon.invalidate();
+		polygon.update(vectex, holeStarts);
+		polygonIndices.sync(polygon.indices(), polygon.firstChanged());
+		requestRedraw();
+		return;
+	}
+
+	uint32_t hovered = vertexGrid.nearest(float(xpos), float(ypos), PICK_RADIUS_IN_PIXELS / camera.view().pixelsPerUnit);
+	if (hovered != hoveredVertex)
+	{
+		hoveredVertex = hovered;
+		requestRedraw();
+	}
+}
+
+void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
+{
+	(void)xoffset;
+	double xpos, ypos;
+	inputCursorPos(window, &xpos, &ypos);
+	camera.scroll(xpos, ypos, yoffset);
+	requestRedraw();
+}
+
+int main(int argc, char **argv)
+{
+	AppOptions options = parseOptions(argc, argv);
+
 	// Initialize the library
 	if (!glfwInit())
 	{
@@ -134,15 +219,8 @@ int main()
 	/* Callback to a function if an error is rised by GLFW */
 	glfwSetErrorCallback(onError);
 
-	// Create a windowed mode window and its OpenGL context
-#ifdef __APPLE__
-	// We need to explicitly ask for a 3.3 context on Mac
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-#endif
-	GLFWwindow *window = glfwCreateWindow(window_width, window_height, "TD2", nullptr, nullptr);
+	// Create a windowed mode window (hidden when headless) and its OpenGL context
+	GLFWwindow *window = createWindow(options, window_width, window_height, "TD2");
 	if (!window)
 	{
 		glfwTerminate();
@@ -158,38 +236,106 @@ int main()
 		return -1;
 	}
 
+	/* Frame rate limit, vsync or uncapped depending on the options */
+	FramePacer pacer(options, FRAMERATE_IN_SECONDS);
+
+	/* Headless : draw into an offscreen framebuffer instead of the window */
+	OffscreenTarget offscreen;
+	if (options.headless)
+	{
+		offscreen.create(window_width, window_height);
+	}
+
+	/* --capture : frames are read back without stalling and written as PNG in the background */
+	FrameCapture capture;
+	if (!options.capturePrefix.empty())
+	{
+		capture.start(options.capturePrefix);
+	}
+
+	if (!options.pointCloud.empty())
+	{
+		pointCloud.open(options.pointCloud);
+	}
+
 	onWindowResized(window, window_width, window_height);
 	glfwSetWindowSizeCallback(window, onWindowResized);
 
 	glfwSetKeyCallback(window, key_callback);
 	glfwSetMouseButtonCallback(window, mouse_button_callback);
+	glfwSetCursorPosCallback(window, cursor_position_callback);
+	glfwSetScrollCallback(window, scroll_callback);
+
+	installRedrawCallbacks(window);
+
+	/* --record / --replay, once every input callback is set ; the loop is
+	   skipped if the file cannot be opened */
+	if (!installInputRecorder(window, options))
+	{
+		glfwSetWindowShouldClose(window, GLFW_TRUE);
+	}
 
 	/* Loop until the user closes the window */
-	while (!glfwWindowShouldClose(window))
+	int frame = 0;
+	while (!glfwWindowShouldClose(window) && !options.finished(frame))
 	{
-		/* Get time (in second) at loop beginning */
-		double startTime = glfwGetTime();
+		/* Sleep while minimized, or until something changed in on-demand mode */
+		if (waitForRedraw(window, options.onDemand))
+		{
+			pacer.restart();
+		}
+		if (glfwWindowShouldClose(window))
+		{
+			break;
+		}
+
+		PROFILE_ZONE("frame");
+
+		/* Eases the wheel zoom, and reloads the projection when the view changed */
+		setAnimating(camera.update());
+		camera.apply();
 
 		/* Render here */
-		glClear(GL_COLOR_BUFFER_BIT);
+		{
+			PROFILE_ZONE("clear");
+			glClear(GL_COLOR_BUFFER_BIT);
+		}
 
 		drawPrimitive(primitive);
 
+		/* Queue the read-back of this frame (--capture) */
+		capture.capture();
+
 		/* Swap front and back buffers */
-		glfwSwapBuffers(window);
+		{
+			PROFILE_ZONE("glfwSwapBuffers");
+			glfwSwapBuffers(window);
+		}
+		frame++;
+		frameDrawn();
+		inputFrame(window, frame);
 
 		/* Poll for and process events */
-		glfwPollEvents();
+		{
+			PROFILE_ZONE("glfwPollEvents");
+			glfwPollEvents();
+		}
 
-		/* Elapsed time computation from loop begining */
-		double elapsedTime = glfwGetTime() - startTime;
-		/* If to few time is spend vs our wanted FPS, we wait */
-		if (elapsedTime < FRAMERATE_IN_SECONDS)
+		/* Wait for the next frame deadline (vsync already waited in glfwSwapBuffers) */
 		{
-			glfwWaitEventsTimeout(FRAMERATE_IN_SECONDS - elapsedTime);
+			PROFILE_ZONE("wait");
+			pacer.endFrame();
 		}
 	}
 
+	vertexBuffer.release();
+	polygonIndices.release();
+	pointCloud.release();
+	stopInputRecorder();
+	capture.stop();
+	pacer.report();
+	PROFILE_EXPORT(options.profileOutput.c_str());
+	offscreen.release();
 	glfwTerminate();
 	return 0;
 }
\ No newline at end of file
@@ -4,16 +4,38 @@
 #include <GL/gl.h>
 #include <vector>
 #include <iostream>
+#include "app/Window.hpp"
+#include "app/Redraw.hpp"
+#include "app/FramePacer.hpp"
+#include "app/FrameCapture.hpp"
+#include "app/InputRecorder.hpp"
+#include "profiling/Profiler.hpp"
+#include "render/Camera2D.hpp"
+#include "render/Vertex.hpp"
+#include "render/VertexBuffer.hpp"
+#include "geometry/Triangulator.hpp"
+#include "spatial/ChunkedBounds.hpp"
+#include "render/CircleCache.hpp"
+#include "render/CircleLod.hpp"
+#include "math/MatrixStack.hpp"
+#include "render/InstancedRenderer.hpp"
+#include "scene/SceneGraph.hpp"
+#include "scene/SecondArm.hpp"
+#include "assets/TextureLoader.hpp"
+#include "render/SpriteBatcher.hpp"
+#include "helpers/RootDir.hpp"
+#include "render/ShaderWatcher.hpp"
 
 #define _USE_MATH_DEFINES
 #include <math.h>
 
 /* Minimal time wanted between two images */
 static const float GL_VIEW_SIZE = 6;
-static float aspectRatio;
 static const double FRAMERATE_IN_SECONDS = 1. / 30.;
 static int window_width = 800;
 static int window_height = 800;
+/* Pan (middle button) and zoom (wheel) on top of the GL_VIEW_SIZE framing */
+static Camera2D camera(GL_VIEW_SIZE);
 static int form = 0;
 static float x_square_center{};
 static float y_square_center{};
@@ -43,13 +65,32 @@ enum Operations
 
 static Primitives primitive;
 
-struct Vertex
-{
-    double posX;
-    double posY;
-};
-
 std::vector<Vertex> vectex{};
+/* Clicked vertices stay in floats on the GPU : one 16-bit frame over every
+   click would move the points by pixels once zoomed in, away from picking */
+static VertexBuffer<VertexF32> vertexBuffer;
+/* Boxes of slices of vectex : drawPrimitive skips those outside the view */
+static ChunkedBounds vertexBounds;
+static std::vector<VertexRange> visibleVertices;
+/* Polygone draws the ear-clipping triangulation of vectex */
+static Triangulator polygon;
+static IndexBuffer polygonIndices;
+static CircleCache circleCache;
+static CircleLod circleLod;
+static MatrixStack modelview;
+/* GLSL programs of assets/shaders, cached as program binaries */
+static ShaderManager shaders;
+static InstancedRenderer shapeRenderer;
+static SceneGraph scene;
+static NodeId secondArm = NO_NODE;
+
+/* Images of assets/, shown along the top of the window once decoded */
+static const char *IMAGE_FILES[] = {"poulpile.jpg", "triforce.jpg", "triforce.png"};
+static const int IMAGE_COUNT = 3;
+static TextureId images[IMAGE_COUNT];
+/* Packed together, the images are drawn in a single call */
+static TextureAtlas atlas;
+static SpriteBatcher sprites;
 
 /* Error handling function */
 void onError(int error, const char *description)
@@ -57,38 +98,46 @@ void onError(int error, const char *description)
     std::cout << "GLFW Error (" << error << ") : " << description << std::endl;
 }
 
+/* False when a box given in the current model coordinates is outside the view */
+static bool isVisible(const Bounds2 &local)
+{
+    return transformBounds(modelview.top().toAffine2(), local).intersects(camera.view().bounds);
+}
+
 void drawPrimitive(Primitives prim)
 {
+    PROFILE_ZONE("drawPrimitive");
     glPointSize(10);
+    /* Points are 10 pixels wide : their centers may be up to 5 pixels outside */
+    const View &view = camera.view();
+    vertexBounds.visibleRanges(view.bounds.expanded(5 / view.pixelsPerUnit), visibleVertices);
     switch (prim)
     {
     case Primitives::Triangle:
-        glBegin(GL_TRIANGLES);
+        vertexBuffer.draw(GL_TRIANGLES, visibleVertices);
         break;
     case Primitives::Quad:
-        glBegin(GL_QUADS);
+        vertexBuffer.draw(GL_QUADS, visibleVertices);
         break;
     case Primitives::Line:
-        glBegin(GL_LINES);
+        vertexBuffer.draw(GL_LINES, visibleVertices);
         break;
     case Primitives::Point:
-        glBegin(GL_POINTS);
+        vertexBuffer.draw(GL_POINTS, visibleVertices);
         break;
     case Primitives::Polygone:
-        glBegin(GL_POLYGON);
+        vertexBuffer.draw(GL_TRIANGLES, polygonIndices);
         break;
     }
-
-    for (Vertex v : vectex)
-    {
-        glVertex2d(v.posX, v.posY);
-    }
-    glEnd();
 }
 
 void drawOrigin()
 {
-
+    PROFILE_ZONE("drawOrigin");
+    if (!isVisible(Bounds2::of(-GL_VIEW_SIZE / 4, -GL_VIEW_SIZE / 4, GL_VIEW_SIZE / 4, GL_VIEW_SIZE / 4)))
+    {
+        return;
+    }
     glBegin(GL_LINES);
 
     glColor3f(1, 0, 0);
@@ -107,19 +156,25 @@ void setup_matrix(Operations operation, float x, float y, float z, float alpha)
     switch (operation)
     {
     case Operations::Translation:
-        glTranslatef(x, y, z);
+        modelview.translate(x, y, z);
         break;
     case Operations::Rotation:
-        glRotatef(alpha, x, y, z);
+        modelview.rotate(alpha, x, y, z);
         break;
     case Operations::Scale:
-        glScalef(x, y, z);
+        modelview.scale(x, y, z);
         break;
     }
+    modelview.load();
 }
 
 void drawSquare(bool full)
 {
+    if (!isVisible(Bounds2::of(-0.5f, -0.5f, 0.5f, 0.5f)))
+    {
+        return;
+    }
+
     full ? glBegin(GL_POLYGON) : glBegin(GL_LINE_LOOP);
 
     glVertex2d(-0.5, 0.5);
@@ -132,42 +187,18 @@ void drawSquare(bool full)
 
 void drawCircle(float x, float y, float r, bool full)
 {
-    glPointSize(5);
-    full ? glBegin(GL_POLYGON) : glBegin(GL_LINE_LOOP);
-    glColor3f(1, 0.5, 0);
-    double teta{0};
-    while (teta <= 2 * M_PI)
+    if (!isVisible(Bounds2::of(x - r, y - r, x + r, y + r)))
     {
-        double xPoint{x + r * cos(teta)};
-        double yPoint{y + r * sin(teta)};
-
-        glVertex2d(xPoint, yPoint);
-
-        teta += (2 * M_PI) / 30;
+        return;
     }
-    glEnd();
-}
-
-void drawRoundedSquare(bool full)
-{
-
-    glPushMatrix();
-    glScalef(1.5, 1, 1);
-    drawSquare(full);
-    glPopMatrix();
-    glPushMatrix();
-    glScalef(1, 1.5, 1);
-    drawSquare(full);
-    glPopMatrix();
-    float dist = 0.75f / 2;
-    drawCircle(-dist, dist, dist, full);
-    drawCircle(dist, dist, dist, full);
-    drawCircle(-dist, -dist, dist, full);
-    drawCircle(dist, -dist, dist, full);
+    glPointSize(5);
+    glColor3f(1, 0.5, 0);
+    circleCache.draw(x, y, r, full, circleLod.segments(r, modelview.top().toAffine2()));
 }
 
 void drawForms(bool full)
 {
+    PROFILE_ZONE("drawForms");
     switch (form)
     {
     case 0:
@@ -179,7 +210,8 @@ void drawForms(bool full)
         drawSquare(full);
     case 2:
         glColor3f(0.64f, 0.1f, 1);
-        glLoadIdentity();
+        modelview.loadIdentity();
+        modelview.load();
         setup_matrix(Operations::Translation, 1, 0, 0, 0);
         setup_matrix(Operations::Rotation, 0, 0, 1, 45);
         setup_matrix(Operations::Translation, 1, 0, 0, 0);
@@ -190,6 +222,7 @@ void drawForms(bool full)
 
 void drawFirstArm()
 {
+    PROFILE_ZONE("drawFirstArm");
     float x1 = 0;
     float y1 = 0;
     float r1 = 0.4;
@@ -207,48 +240,38 @@ void drawFirstArm()
     glEnd();
 }
 
-void drawSecondArm()
+/* Shapes recorded by each task of drawSecondArm(), reused every frame */
+static std::vector<DrawList> drawLists;
+
+void drawSecondArm(ThreadPool &recorders)
 {
-    glPushMatrix();
-    glScalef(0.2f, 0.2f, 0.2f);
-    drawRoundedSquare(0);
-    glPopMatrix();
-    glPushMatrix();
-    glTranslatef(0.1f, 0, 0);
-    glScalef(1.5f, 0.2f, 0.2f);
-    drawSquare(0);
-    glPopMatrix();
-    glPushMatrix();
-    glTranslatef(1.6f, 0, 0);
-    glScalef(0.2f, 0.2f, 0.2f);
-    drawRoundedSquare(0);
-    glPopMatrix();
+    PROFILE_ZONE("drawSecondArm");
+    if (secondArm == NO_NODE)
+    {
+        secondArm = buildSecondArm(scene);
+    }
+    /* Workers update and record the subtrees once the scene is large enough
+       (this single arm stays on this thread) ; only the merge touches the
+       renderer */
+    scene.updateAndRecord(recorders, shapeRenderer, camera.view().bounds, drawLists);
+    for (const DrawList &list : drawLists)
+    {
+        shapeRenderer.merge(list);
+    }
 }
 
 void onWindowResized(GLFWwindow *window, int width, int height)
 {
-    aspectRatio = width / (float)height;
+    requestRedraw();
     window_width = width;
     window_height = height;
     glViewport(0, 0, width, height);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    if (aspectRatio > 1)
-    {
-        glOrtho(
-            -GL_VIEW_SIZE / 2. * aspectRatio, GL_VIEW_SIZE / 2. * aspectRatio,
-            -GL_VIEW_SIZE / 2., GL_VIEW_SIZE / 2., -1.0, 1.0);
-    }
-    else
-    {
-        glOrtho(
-            -GL_VIEW_SIZE / 2., GL_VIEW_SIZE / 2.,
-            -GL_VIEW_SIZE / 2. / aspectRatio, GL_VIEW_SIZE / 2. / aspectRatio, -1.0, 1.0);
-    }
+    camera.setViewport(width, height);
 }
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods)
 {
+    requestRedraw();
     if (key == GLFW_KEY_Q && action == GLFW_PRESS)
     {
         glfwSetWindowShouldClose(window, GLFW_TRUE);
@@ -257,30 +280,69 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
 {
+    requestRedraw();
+    double xpos, ypos;
+    inputCursorPos(window, &xpos, &ypos);
+    if (camera.mouseButton(button, action, xpos, ypos))
+    {
+        return;
+    }
+
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
     {
-        double xpos, ypos;
-        glfwGetCursorPos(window, &xpos, &ypos);
-        if (aspectRatio >= 1)
-        {
-            xpos = (GL_VIEW_SIZE / 2) * (aspectRatio * (xpos * (double(2) / window_width) - 1));
-            ypos = (GL_VIEW_SIZE / 2) * (-ypos * (double(2) / window_height) + 1);
-        }
-        else
-        {
-            xpos = (GL_VIEW_SIZE / 2) * (xpos * (double(2) / window_width) - 1);
-            ypos = (GL_VIEW_SIZE / 2) * (1 / aspectRatio * (-ypos * (double(2) / window_height) + 1));
-        }
+        camera.toWorld(xpos, ypos);
 
-        Vertex v{xpos, ypos};
+        Vertex v{float(xpos), float(ypos)};
         vectex.push_back(v);
+        vertexBuffer.sync(vectex);
+        vertexBounds.sync(vectex);
+        polygon.update(vectex);
+        polygonIndices.sync(polygon.indices(), polygon.firstChanged());
         x_square_center = float(v.posX);
         y_square_center = float(v.posY);
     }
 }
 
-int main()
+void cursor_position_callback(GLFWwindow *window, double xpos, double ypos)
+{
+    (void)window;
+    if (camera.cursorMoved(xpos, ypos))
+    {
+        requestRedraw();
+    }
+}
+
+void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
+{
+    (void)xoffset;
+    double xpos, ypos;
+    inputCursorPos(window, &xpos, &ypos);
+    camera.scroll(xpos, ypos, yoffset);
+    requestRedraw();
+}
+
+void drawImages(const TextureLoader &textures)
+{
+    PROFILE_ZONE("drawImages");
+    float x = -GL_VIEW_SIZE / 2 + 0.1f;
+    for (int i = 0; i < IMAGE_COUNT; i++)
+    {
+        /* One unit high, keeping the image ratio */
+        const Texture &texture = textures.texture(images[i]);
+        if (texture.ready())
+        {
+            float width = float(texture.width) / texture.height;
+            sprites.add(texture, x, GL_VIEW_SIZE / 2 - 1.1f, width, 1);
+            x += width + 0.1f;
+        }
+    }
+    sprites.flush();
+}
+
+int main(int argc, char **argv)
 {
+    AppOptions options = parseOptions(argc, argv);
+
     // Initialize the library
     if (!glfwInit())
     {
@@ -290,15 +352,8 @@ int main()
     /* Callback to a function if an error is rised by GLFW */
     glfwSetErrorCallback(onError);
 
-    // Create a windowed mode window and its OpenGL context
-#ifdef __APPLE__
-    // We need to explicitly ask for a 3.3 context on Mac
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-#endif
-    GLFWwindow *window = glfwCreateWindow(window_width, window_height, "TD2", nullptr, nullptr);
+    // Create a windowed mode window (hidden when headless) and its OpenGL context
+    GLFWwindow *window = createWindow(options, window_width, window_height, "TD2");
     if (!window)
     {
         glfwTerminate();
@@ -314,42 +369,147 @@ int main()
         return -1;
     }
 
+    /* Frame rate limit, vsync or uncapped depending on the options */
+    FramePacer pacer(options, FRAMERATE_IN_SECONDS);
+
+    /* Headless : draw into an offscreen framebuffer instead of the window */
+    OffscreenTarget offscreen;
+    if (options.headless)
+    {
+        offscreen.create(window_width, window_height);
+    }
+
+    /* --capture : frames are read back without stalling and written as PNG in the background */
+    FrameCapture capture;
+    if (!options.capturePrefix.empty())
+    {
+        capture.start(options.capturePrefix);
+    }
+
+    shapeRenderer.setShaders(shaders);
+    /* Edited shaders are rebuilt at the start of the next frame */
+    ShaderWatcher shaderWatcher;
+    shaderWatcher.start(shaders.directory());
+    std::vector<std::string> changedShaders;
+
     onWindowResized(window, window_width, window_height);
     glfwSetWindowSizeCallback(window, onWindowResized);
 
+    /* Decoded on worker threads while the first frames are already drawn */
+    ThreadPool workers;
+    TextureLoader textures(workers);
+    /* Separate from the decoders, so recording never waits behind an image */
+    ThreadPool recorders;
+    /* `make bake_textures` skips the decoding */
+    BakedTextures baked;
+    if (baked.open(std::string(ROOT_DIR) + "assets/textures.baked"))
+    {
+        textures.useBaked(&baked);
+    }
+    for (int i = 0; i < IMAGE_COUNT; i++)
+    {
+        images[i] = textures.loadSprite(std::string(ROOT_DIR) + "assets/" + IMAGE_FILES[i], atlas);
+    }
+
     glfwSetKeyCallback(window, key_callback);
     glfwSetMouseButtonCallback(window, mouse_button_callback);
+    glfwSetCursorPosCallback(window, cursor_position_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    installRedrawCallbacks(window);
+
+    /* --record / --replay, once every input callback is set ; the loop is
+       skipped if the file cannot be opened */
+    if (!installInputRecorder(window, options))
+    {
+        glfwSetWindowShouldClose(window, GLFW_TRUE);
+    }
 
     /* Loop until the user closes the window */
-    while (!glfwWindowShouldClose(window))
+    int frame = 0;
+    while (!glfwWindowShouldClose(window) && !options.finished(frame))
     {
-        /* Get time (in second) at loop beginning */
-        double startTime = glfwGetTime();
+        /* Sleep while minimized, or until something changed in on-demand mode */
+        if (waitForRedraw(window, options.onDemand))
+        {
+            pacer.restart();
+        }
+        if (glfwWindowShouldClose(window))
+        {
+            break;
+        }
+
+        PROFILE_ZONE("frame");
+
+        /* Eases the wheel zoom, and reloads the projection when the view changed */
+        setAnimating(camera.update());
+        if (camera.apply())
+        {
+            circleLod.setPixelsPerUnit(camera.view().pixelsPerUnit);
+            shapeRenderer.lod().setPixelsPerUnit(camera.view().pixelsPerUnit);
+        }
+
+        /* Upload the images decoded since the last frame */
+        textures.poll();
+        shaderWatcher.poll(changedShaders);
+        if (!changedShaders.empty())
+        {
+            shaders.reload(changedShaders);
+        }
 
         /* Render here */
-        glMatrixMode(GL_MODELVIEW);
-        glLoadIdentity();
-        glClear(GL_COLOR_BUFFER_BIT);
+        modelview.loadIdentity();
+        modelview.load();
+        {
+            PROFILE_ZONE("clear");
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
 
         drawOrigin();
         // drawFirstArm();
-        drawSecondArm();
+        drawSecondArm(recorders);
+        shapeRenderer.flush();
+        drawImages(textures);
+
+        /* Queue the read-back of this frame (--capture) */
+        capture.capture();
 
         /* Swap front and back buffers */
-        glfwSwapBuffers(window);
+        {
+            PROFILE_ZONE("glfwSwapBuffers");
+            glfwSwapBuffers(window);
+        }
+        frame++;
+        frameDrawn();
+        inputFrame(window, frame);
 
         /* Poll for and process events */
-        glfwPollEvents();
+        {
+            PROFILE_ZONE("glfwPollEvents");
+            glfwPollEvents();
+        }
 
-        /* Elapsed time computation from loop begining */
-        double elapsedTime = glfwGetTime() - startTime;
-        /* If to few time is spend vs our wanted FPS, we wait */
-        if (elapsedTime < FRAMERATE_IN_SECONDS)
+        /* Wait for the next frame deadline (vsync already waited in glfwSwapBuffers) */
         {
-            glfwWaitEventsTimeout(FRAMERATE_IN_SECONDS - elapsedTime);
+            PROFILE_ZONE("wait");
+            pacer.endFrame();
         }
     }
 
+    vertexBuffer.release();
+    polygonIndices.release();
+    circleCache.release();
+    shapeRenderer.release();
+    shaderWatcher.stop();
+    shaders.release();
+    textures.release();
+    atlas.release();
+    sprites.release();
+    stopInputRecorder();
+    capture.stop();
+    pacer.report();
+    PROFILE_EXPORT(options.profileOutput.c_str());
+    offscreen.release();
     glfwTerminate();
     return 0;
 }
@@ -0,0 +1,8 @@
+#version 330 compatibility
+in vec4 vertexColor;
+out vec4 fragmentColor;
+
+void main()
+{
+    fragmentColor = vertexColor;
+}
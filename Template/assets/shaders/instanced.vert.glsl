@@ -0,0 +1,14 @@
+#version 330 compatibility
+/* InstancedRenderer : one shape mesh, one 2x3 transform and color per instance */
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec3 transformRow0;
+layout(location = 2) in vec3 transformRow1;
+layout(location = 3) in vec4 color;
+out vec4 vertexColor;
+
+void main()
+{
+    vec3 p = vec3(position, 1.0);
+    gl_Position = gl_ModelViewProjectionMatrix * vec4(dot(transformRow0, p), dot(transformRow1, p), 0.0, 1.0);
+    vertexColor = color;
+}
@@ -0,0 +1,521 @@
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h"
+#include "glad/glad.h"
+#include <GL/gl.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "app/Window.hpp"
+#include "concurrency/ThreadPool.hpp"
+#include "render/CircleCache.hpp"
+#include "render/CircleLod.hpp"
+#include "render/InstancedRenderer.hpp"
+#include "render/ShaderManager.hpp"
+#include "render/Vertex.hpp"
+#include "render/VertexBuffer.hpp"
+#include "render/View.hpp"
+#include "scene/SceneGraph.hpp"
+#include "scene/SecondArm.hpp"
+
+/* Scene benchmarks :
+     bench [--frames N] [--counts N,N...] [--scenes primitive,circle,arm]
+           [--threads N] [--output FILE] [--baseline FILE] [--tolerance T] [--update-baseline]
+   draws scaled-up versions of the TD scenes headless : N vertices like
+   drawPrimitive, N circles like drawCircle, N arms like drawSecondArm (updated
+   and recorded by N worker threads with --threads, then merged). Every
+   frame ends with glFinish so the GPU work is timed too. Results go to FILE
+   (stdout by default) as JSON ; with --baseline, a scene whose frame rate fell
+   more than T (0.1 = 10%) below the baseline, or no scene in the baseline at
+   all, makes the exit status 2. A missing baseline is an error (1) : it is
+   only written with --update-baseline.
+   Progress and comparisons are printed on stderr. */
+
+static const int BENCH_WIDTH = 1280;
+static const int BENCH_HEIGHT = 720;
+/* Frames drawn before timing : buffers, shaders and the driver settle */
+static const int WARMUP_FRAMES = 10;
+
+enum class BenchScene
+{
+    Primitive,
+    Circle,
+    Arm
+};
+
+static const char *SCENE_NAMES[] = {"primitive", "circle", "arm"};
+static const int SCENE_COUNT = 3;
+
+struct BenchResult
+{
+    std::string scene;
+    int count = 0;
+    int threads = 0;
+    int frames = 0;
+    double fps = 0;
+    double p50 = 0;
+    double p95 = 0;
+    double p99 = 0;
+    double verticesPerSecond = 0;
+};
+
+struct BenchOptions
+{
+    int frames = 300;
+    std::vector<int> counts = {1000, 10000, 100000};
+    std::vector<BenchScene> scenes = {BenchScene::Primitive, BenchScene::Circle, BenchScene::Arm};
+    std::string output;
+    std::string baseline;
+    double tolerance = 0.1;
+    bool updateBaseline = false;
+    /* 0 : the arm scene is updated and recorded on the GL thread */
+    int threads = 0;
+};
+
+/* Same framing as the TD executables' onWindowResized() */
+static void setProjection(float viewSize)
+{
+    float aspectRatio = BENCH_WIDTH / float(BENCH_HEIGHT);
+    glViewport(0, 0, BENCH_WIDTH, BENCH_HEIGHT);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(-viewSize / 2. * aspectRatio, viewSize / 2. * aspectRatio, -viewSize / 2., viewSize / 2., -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+}
+
+/* Draws the scene once per frame, returns the vertices sent by the last one */
+class SceneRunner
+{
+public:
+    /* `recorders` : workers of the arm scene, nullptr to stay on this thread */
+    SceneRunner(BenchScene scene, int count, ThreadPool *recorders);
+    size_t draw(int frame);
+    void release();
+
+private:
+    BenchScene scene;
+    std::mt19937 random;
+
+    /* primitive : one vertex buffer drawn as triangles */
+    std::vector<Vertex> vertices;
+    VertexBuffer<VertexF32> vertexBuffer;
+
+    /* circle : outlines of every size through the cached tessellations */
+    std::vector<float> circles;
+    CircleCache circleCache;
+    CircleLod circleLod;
+
+    /* arm : one second arm per node, all turning */
+    ShaderManager shaders;
+    InstancedRenderer shapeRenderer;
+    SceneGraph graph;
+    std::vector<NodeId> arms;
+    Bounds2 visible;
+    ThreadPool *recorders;
+    std::vector<DrawList> drawLists;
+};
+
+SceneRunner::SceneRunner(BenchScene scene, int count, ThreadPool *recorders)
+    : scene(scene), random(42), recorders(recorders)
+{
+    std::uniform_real_distribution<float> unit(-1, 1);
+    switch (scene)
+    {
+    case BenchScene::Primitive:
+        setProjection(2);
+        vertices.resize(size_t(count));
+        for (Vertex &v : vertices)
+        {
+            v.posX = unit(random);
+            v.posY = unit(random);
+        }
+        vertexBuffer.sync(vertices);
+        break;
+    case BenchScene::Circle:
+    {
+        setProjection(2);
+        circleLod.setViewport(BENCH_WIDTH, BENCH_HEIGHT, 2);
+        std::uniform_real_distribution<float> radius(0.01f, 0.3f);
+        for (int i = 0; i < count; i++)
+        {
+            circles.push_back(unit(random));
+            circles.push_back(unit(random));
+            circles.push_back(radius(random));
+        }
+        break;
+    }
+    case BenchScene::Arm:
+        setProjection(6);
+        visible = orthoView(BENCH_WIDTH, BENCH_HEIGHT, 6).bounds;
+        shapeRenderer.setShaders(shaders);
+        shapeRenderer.lod().setViewport(BENCH_WIDTH, BENCH_HEIGHT, 6);
+        for (int i = 0; i < count; i++)
+        {
+            NodeId arm = buildSecondArm(graph);
+            graph.setTranslation(arm, 3 * unit(random), 3 * unit(random));
+            graph.setRotation(arm, 180 * unit(random));
+            arms.push_back(arm);
+        }
+        break;
+    }
+}
+
+size_t SceneRunner::draw(int frame)
+{
+    size_t drawn = 0;
+    switch (scene)
+    {
+    case BenchScene::Primitive:
+        glPointSize(10);
+        vertexBuffer.draw(GL_TRIANGLES, 0, vertexBuffer.size() / 3 * 3);
+        drawn = vertexBuffer.size() / 3 * 3;
+        break;
+    case BenchScene::Circle:
+        glPointSize(5);
+        glColor3f(0, 0, 1);
+        for (size_t i = 0; i < circles.size(); i += 3)
+        {
+            int segments = circleLod.segments(circles[i + 2]);
+            circleCache.draw(circles[i], circles[i + 1], circles[i + 2], false, segments);
+            drawn += size_t(segments);
+        }
+        break;
+    case BenchScene::Arm:
+        /* Every arm moves, so every world transform is recomputed */
+        for (size_t i = 0; i < arms.size(); i++)
+        {
+            graph.setRotation(arms[i], float(frame + i));
+        }
+        if (recorders)
+        {
+            graph.updateAndRecord(*recorders, shapeRenderer, visible, drawLists);
+            for (const DrawList &list : drawLists)
+            {
+                shapeRenderer.merge(list);
+            }
+        }
+        else
+        {
+            graph.update();
+            graph.draw(shapeRenderer, visible);
+        }
+        shapeRenderer.flush();
+        drawn = shapeRenderer.drawnVertices();
+        break;
+    }
+    return drawn;
+}
+
+void SceneRunner::release()
+{
+    vertexBuffer.release();
+    circleCache.release();
+    shapeRenderer.release();
+    shaders.release();
+}
+
+static double percentile(std::vector<double> times, double p)
+{
+    std::sort(times.begin(), times.end());
+    return times[size_t(p * (times.size() - 1))];
+}
+
+static BenchResult runScene(GLFWwindow *window, BenchScene scene, int count, int frames, ThreadPool *recorders)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    SceneRunner runner(scene, count, recorders);
+    std::vector<double> frameTimes;
+    double vertices = 0;
+    double total = 0;
+    for (int frame = 0; frame < WARMUP_FRAMES + frames; frame++)
+    {
+        Clock::time_point start = Clock::now();
+        glClear(GL_COLOR_BUFFER_BIT);
+        size_t drawn = runner.draw(frame);
+        glfwSwapBuffers(window);
+        glFinish();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (frame >= WARMUP_FRAMES)
+        {
+            frameTimes.push_back(seconds * 1000);
+            vertices += double(drawn);
+            total += seconds;
+        }
+    }
+    runner.release();
+
+    BenchResult result;
+    result.scene = SCENE_NAMES[int(scene)];
+    result.count = count;
+    result.threads = scene == BenchScene::Arm && recorders ? int(recorders->size()) : 0;
+    result.frames = frames;
+    result.fps = frames / total;
+    result.p50 = percentile(frameTimes, 0.50);
+    result.p95 = percentile(frameTimes, 0.95);
+    result.p99 = percentile(frameTimes, 0.99);
+    result.verticesPerSecond = vertices / total;
+    return result;
+}
+
+/* One result per line, which is also what readResults() expects */
+static void writeResults(std::ostream &out, const std::vector<BenchResult> &results)
+{
+    out << "{\n  \"width\": " << BENCH_WIDTH << ",\n  \"height\": " << BENCH_HEIGHT << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult &r = results[i];
+        out << "    {\"scene\": \"" << r.scene << "\", \"count\": " << r.count << ", \"threads\": " << r.threads
+            << ", \"frames\": " << r.frames
+            << ", \"fps\": " << r.fps << ", \"p50_ms\": " << r.p50 << ", \"p95_ms\": " << r.p95
+            << ", \"p99_ms\": " << r.p99 << ", \"vertices_per_second\": " << r.verticesPerSecond << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+static bool jsonNumber(const std::string &line, const char *key, double &value)
+{
+    size_t found = line.find(std::string("\"") + key + "\":");
+    if (found == std::string::npos)
+    {
+        return false;
+    }
+    value = strtod(line.c_str() + found + strlen(key) + 3, nullptr);
+    return true;
+}
+
+/* Reads back a file written by writeResults() */
+static bool readResults(const std::string &path, std::vector<BenchResult> &results)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line))
+    {
+        size_t scene = line.find("\"scene\": \"");
+        if (scene == std::string::npos)
+        {
+            continue;
+        }
+        BenchResult result;
+        scene += strlen("\"scene\": \"");
+        result.scene = line.substr(scene, line.find('"', scene) - scene);
+        double count = 0;
+        if (!jsonNumber(line, "count", count) || !jsonNumber(line, "fps", result.fps))
+        {
+            continue;
+        }
+        result.count = int(count);
+        double threads = 0;
+        jsonNumber(line, "threads", threads);
+        result.threads = int(threads);
+        jsonNumber(line, "p95_ms", result.p95);
+        results.push_back(result);
+    }
+    return true;
+}
+
+/* Prints the comparison, true if no scene is slower than the tolerance allows
+   and at least one scene could be compared */
+static bool compare(const std::vector<BenchResult> &results, const std::vector<BenchResult> &baseline, double tolerance)
+{
+    bool passed = true;
+    int compared = 0;
+    for (const BenchResult &r : results)
+    {
+        const BenchResult *reference = nullptr;
+        for (const BenchResult &b : baseline)
+        {
+            if (b.scene == r.scene && b.count == r.count && b.threads == r.threads)
+            {
+                reference = &b;
+            }
+        }
+        std::cerr << r.scene << " x " << r.count << " : ";
+        if (!reference)
+        {
+            std::cerr << "not in the baseline" << std::endl;
+            continue;
+        }
+        compared++;
+        double ratio = r.fps / reference->fps;
+        bool regressed = ratio < 1 - tolerance;
+        passed = passed && !regressed;
+        std::cerr << r.fps << " fps against " << reference->fps << " (" << (ratio - 1) * 100 << "%)"
+                  << (regressed ? " REGRESSION" : "") << std::endl;
+    }
+    if (!compared)
+    {
+        std::cerr << "No scene matches the baseline" << std::endl;
+        return false;
+    }
+    return passed;
+}
+
+static std::vector<std::string> split(const char *list)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        items.push_back(item);
+    }
+    return items;
+}
+
+static bool parseBenchOptions(int argc, char **argv, BenchOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--frames") == 0 && hasValue)
+        {
+            options.frames = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--counts") == 0 && hasValue)
+        {
+            options.counts.clear();
+            for (const std::string &count : split(argv[++i]))
+            {
+                options.counts.push_back(std::max(1, atoi(count.c_str())));
+            }
+        }
+        else if (strcmp(argv[i], "--scenes") == 0 && hasValue)
+        {
+            options.scenes.clear();
+            for (const std::string &name : split(argv[++i]))
+            {
+                int scene = 0;
+                while (scene < SCENE_COUNT && name != SCENE_NAMES[scene])
+                {
+                    scene++;
+                }
+                if (scene == SCENE_COUNT)
+                {
+                    std::cerr << "Unknown scene : " << name << std::endl;
+                    return false;
+                }
+                options.scenes.push_back(BenchScene(scene));
+            }
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+        {
+            options.threads = std::max(0, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--output") == 0 && hasValue)
+        {
+            options.output = argv[++i];
+        }
+        else if (strcmp(argv[i], "--baseline") == 0 && hasValue)
+        {
+            options.baseline = argv[++i];
+        }
+        else if (strcmp(argv[i], "--tolerance") == 0 && hasValue)
+        {
+            options.tolerance = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--update-baseline") == 0)
+        {
+            options.updateBaseline = true;
+        }
+        else
+        {
+            std::cerr << "Unknown option : " << argv[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    if (!parseBenchOptions(argc, argv, options))
+    {
+        return 1;
+    }
+
+    if (!glfwInit())
+    {
+        return 1;
+    }
+    AppOptions windowOptions;
+    windowOptions.headless = true;
+    GLFWwindow *window = createWindow(windowOptions, BENCH_WIDTH, BENCH_HEIGHT, "bench");
+    if (!window)
+    {
+        std::cerr << "Cannot create a GL context" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cerr << "Failed to initialize OpenGL context" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwSwapInterval(0);
+
+    OffscreenTarget offscreen;
+    offscreen.create(BENCH_WIDTH, BENCH_HEIGHT);
+
+    ThreadPool recorders(unsigned(std::max(1, options.threads)));
+
+    std::vector<BenchResult> results;
+    for (BenchScene scene : options.scenes)
+    {
+        for (int count : options.counts)
+        {
+            results.push_back(runScene(window, scene, count, options.frames, options.threads ? &recorders : nullptr));
+            const BenchResult &r = results.back();
+            std::cerr << r.scene << " x " << r.count << " : " << r.fps << " fps, p95 " << r.p95 << " ms" << std::endl;
+        }
+    }
+
+    offscreen.release();
+    glfwTerminate();
+
+    if (options.output.empty())
+    {
+        writeResults(std::cout, results);
+    }
+    else
+    {
+        std::ofstream out(options.output);
+        writeResults(out, results);
+    }
+
+    if (options.baseline.empty())
+    {
+        return 0;
+    }
+    if (options.updateBaseline)
+    {
+        std::ofstream out(options.baseline);
+        writeResults(out, results);
+        std::cerr << "Baseline written to " << options.baseline << std::endl;
+        return 0;
+    }
+    std::vector<BenchResult> baseline;
+    if (!readResults(options.baseline, baseline))
+    {
+        std::cerr << "Cannot read the baseline " << options.baseline << ", record it with --update-baseline"
+                  << std::endl;
+        return 1;
+    }
+    return compare(results, baseline, options.tolerance) ? 0 : 2;
+}
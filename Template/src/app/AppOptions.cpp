@@ -0,0 +1,96 @@
+#include "app/AppOptions.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+AppOptions parseOptions(int argc, char **argv)
+{
+    AppOptions options;
+
+    const char *headlessVariable = getenv("TD_HEADLESS");
+    if (headlessVariable && strcmp(headlessVariable, "0") != 0)
+    {
+        options.headless = true;
+    }
+#ifdef TD_HEADLESS_OSMESA
+    /* GLFW was built without a window system */
+    options.headless = true;
+#endif
+
+    bool pacingChosen = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--headless") == 0)
+        {
+            options.headless = true;
+        }
+        else if (strcmp(argv[i], "--uncapped") == 0)
+        {
+            options.pacing = PacingMode::Uncapped;
+            pacingChosen = true;
+        }
+        else if (strcmp(argv[i], "--vsync") == 0)
+        {
+            options.pacing = PacingMode::VSync;
+            pacingChosen = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+            {
+                options.swapInterval = atoi(argv[++i]);
+            }
+        }
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+        {
+            options.pacing = PacingMode::FixedRate;
+            options.frameRate = atof(argv[++i]);
+            pacingChosen = true;
+        }
+        else if (strcmp(argv[i], "--on-demand") == 0)
+        {
+            options.onDemand = true;
+        }
+        else if (strcmp(argv[i], "--capped") == 0)
+        {
+            options.pacing = PacingMode::FixedRate;
+            pacingChosen = true;
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            options.frames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+        {
+            options.profileOutput = argv[++i];
+        }
+        else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+        {
+            options.capturePrefix = argv[++i];
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            options.recordInput = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            options.replayInput = argv[++i];
+        }
+        else if (strcmp(argv[i], "--points") == 0 && i + 1 < argc)
+        {
+            options.pointCloud = argv[++i];
+        }
+        else
+        {
+            std::cout << "Unknown option : " << argv[i] << std::endl;
+        }
+    }
+
+    if ((options.headless || !options.replayInput.empty()) && !pacingChosen)
+    {
+        options.pacing = PacingMode::Uncapped;
+    }
+    if (options.headless || !options.replayInput.empty())
+    {
+        /* No input will ever come, or only between frames */
+        options.onDemand = false;
+    }
+    return options;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+
+/* How the main loop spaces its frames */
+enum class PacingMode
+{
+    FixedRate, /* hybrid sleep/spin until the next deadline */
+    VSync,     /* glfwSwapInterval(swapInterval), swapping blocks */
+    Uncapped   /* as fast as possible */
+};
+
+/* Runtime switches shared by every TD executable, read from the command line :
+     --headless        no visible window, render into an offscreen framebuffer
+                       (also enabled by the TD_HEADLESS environment variable)
+     --frames N        stop after N frames
+     --fps N           fixed-rate pacing at N frames per second
+                       (default : the executable's FRAMERATE_IN_SECONDS)
+     --vsync [N]       vsync pacing, swapping every N screen refreshes (1)
+     --uncapped        no pacing at all (default when headless, --capped
+                       keeps the fixed rate)
+     --on-demand       only draw when an input or an animation changed the scene
+                       (ignored when headless)
+     --profile FILE    where the Chrome trace goes in TD_PROFILING builds
+     --capture PREFIX  write the drawn frames to PREFIX000000.png, PREFIX000001.png...
+                       numbered without gaps ; frames the capture cannot keep
+                       up with are skipped
+     --record FILE     write every input event to FILE
+     --replay FILE     feed the events of FILE back instead of the window's
+                       input, uncapped, then quit
+     --points FILE     stream a float32 (x, y) point cloud, drawn with the
+                       Point primitive (executables that support it) */
+struct AppOptions
+{
+    bool headless = false;
+    bool onDemand = false;
+    int frames = 0;
+    PacingMode pacing = PacingMode::FixedRate;
+    int swapInterval = 1;
+    double frameRate = 0;
+    std::string profileOutput = "profile.json";
+    std::string pointCloud;
+    std::string capturePrefix;
+    std::string recordInput;
+    std::string replayInput;
+
+    /* True once `frame` frames have been drawn and a frame limit was given */
+    bool finished(int frame) const { return frames > 0 && frame >= frames; }
+};
+
+AppOptions parseOptions(int argc, char **argv);
@@ -0,0 +1,143 @@
+#include "app/FrameCapture.hpp"
+#include "profiling/Profiler.hpp"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+/* Encoded frames waiting for a writer, beyond that frames are dropped */
+static const int MAX_QUEUED_FRAMES = 32;
+static const int WRITER_THREADS = 2;
+
+void FrameCapture::start(const std::string &prefix)
+{
+    outputPrefix = prefix;
+    writers.reset(new ThreadPool(WRITER_THREADS));
+    /* glReadPixels rows go from bottom to top ; fast compression keeps the
+       writers ahead of the frame rate */
+    stbi_flip_vertically_on_write(1);
+    stbi_write_png_compression_level = 1;
+}
+
+void FrameCapture::collect(Slot &slot)
+{
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    if (queued >= MAX_QUEUED_FRAMES)
+    {
+        dropped++;
+        return;
+    }
+
+    std::shared_ptr<std::vector<uint8_t>> pixels = std::make_shared<std::vector<uint8_t>>(size_t(slot.width) * slot.height * 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    void *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, GLsizeiptr(pixels->size()), GL_MAP_READ_BIT);
+    if (mapped)
+    {
+        memcpy(pixels->data(), mapped, pixels->size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!mapped)
+    {
+        dropped++;
+        return;
+    }
+
+    /* Numbered in the order they are kept, so skipped frames leave no gap */
+    char name[32];
+    snprintf(name, sizeof(name), "%06d.png", fileNumber++);
+    std::string path = outputPrefix + name;
+    int width = slot.width;
+    int height = slot.height;
+    queued++;
+    writers->submit([this, pixels, path, width, height]() {
+        PROFILE_ZONE("writeCapture");
+        if (stbi_write_png(path.c_str(), width, height, 4, pixels->data(), width * 4))
+        {
+            written++;
+        }
+        else
+        {
+            std::cout << "Cannot write " << path << std::endl;
+        }
+        queued--;
+    });
+}
+
+void FrameCapture::capture()
+{
+    if (!active())
+    {
+        return;
+    }
+    PROFILE_ZONE("FrameCapture::capture");
+
+    Slot &slot = slots[next];
+    if (slot.fence)
+    {
+        /* Never wait : a copy still running means this frame is skipped */
+        GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            skipped++;
+            return;
+        }
+        collect(slot);
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (!slot.buffer)
+    {
+        glGenBuffers(1, &slot.buffer);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (slot.width != viewport[2] || slot.height != viewport[3])
+    {
+        slot.width = viewport[2];
+        slot.height = viewport[3];
+        glBufferData(GL_PIXEL_PACK_BUFFER, GLsizeiptr(slot.width) * slot.height * 4, nullptr, GL_STREAM_READ);
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(viewport[0], viewport[1], slot.width, slot.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    next = (next + 1) % RING_SIZE;
+}
+
+void FrameCapture::stop()
+{
+    if (!active())
+    {
+        return;
+    }
+
+    /* The last frames, oldest first ; waiting is fine now */
+    for (int i = 0; i < RING_SIZE; i++)
+    {
+        Slot &slot = slots[(next + i) % RING_SIZE];
+        if (slot.fence)
+        {
+            glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(1000000000));
+            collect(slot);
+        }
+        if (slot.buffer)
+        {
+            glDeleteBuffers(1, &slot.buffer);
+        }
+        slot = Slot();
+    }
+    writers.reset();
+
+    std::cout << "Captured " << written << " frames to " << outputPrefix << "*.png";
+    if (skipped || dropped)
+    {
+        std::cout << " (" << skipped << " skipped by the GPU, " << dropped << " dropped by the writers)";
+    }
+    std::cout << std::endl;
+    outputPrefix.clear();
+}
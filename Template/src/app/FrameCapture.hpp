@@ -0,0 +1,55 @@
+#pragma once
+#include "glad/glad.h"
+#include "concurrency/ThreadPool.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Asynchronous capture of the drawn frames to numbered PNG files.
+
+   capture() only queues a glReadPixels into one of RING_SIZE pixel buffer
+   objects and a fence ; the pixels are mapped RING_SIZE frames later, once
+   the fence says the copy is done, so the CPU never waits for the GPU. If a
+   buffer is still in flight when its turn comes back, that frame is skipped
+   rather than stalling. Encoding and writing run on background threads,
+   which also drop frames instead of queueing without bound. */
+class FrameCapture
+{
+public:
+    /* Frames are written to `prefix` followed by a number and .png ; the
+       numbers count the written files, not the frames of the loop */
+    void start(const std::string &prefix);
+
+    bool active() const { return !outputPrefix.empty(); }
+
+    /* After drawing a frame, before swapping : reads back the viewport of
+       the current read framebuffer */
+    void capture();
+
+    /* Collects the frames still in flight and waits for the files */
+    void stop();
+
+    static const int RING_SIZE = 3;
+
+private:
+    struct Slot
+    {
+        GLuint buffer = 0;
+        GLsync fence = nullptr;
+        int width = 0;
+        int height = 0;
+    };
+
+    void collect(Slot &slot);
+
+    std::string outputPrefix;
+    Slot slots[RING_SIZE];
+    int next = 0;
+    int fileNumber = 0;
+    int skipped = 0;
+    std::unique_ptr<ThreadPool> writers;
+    std::atomic<int> queued{0};
+    std::atomic<int> dropped{0};
+    std::atomic<int> written{0};
+};
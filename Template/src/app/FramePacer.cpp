@@ -0,0 +1,96 @@
+#include "app/FramePacer.hpp"
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+/* Sleeps are rarely more precise than a millisecond or two */
+const double FramePacer::SPIN_MARGIN = 0.002;
+const double FramePacer::JITTER_BOUND = 0.0005;
+
+/* Jitter samples kept for the report */
+static const size_t JITTER_HISTORY = 4096;
+
+FramePacer::FramePacer(const AppOptions &options, double defaultFramePeriod) : mode(options.pacing)
+{
+    double seconds = options.frameRate > 0 ? 1. / options.frameRate : defaultFramePeriod;
+    period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+
+    glfwSwapInterval(mode == PacingMode::VSync ? options.swapInterval : 0);
+}
+
+void FramePacer::restart()
+{
+    started = false;
+}
+
+void FramePacer::endFrame()
+{
+    Clock::time_point now = Clock::now();
+    if (!started)
+    {
+        started = true;
+        deadline = now + period;
+        lastFrameEnd = now;
+        return;
+    }
+
+    if (mode == PacingMode::FixedRate)
+    {
+        if (now > deadline)
+        {
+            missed++;
+            deadline = now;
+        }
+        else
+        {
+            Clock::duration spinMargin = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(SPIN_MARGIN));
+            if (deadline - now > spinMargin)
+            {
+                std::this_thread::sleep_for(deadline - now - spinMargin);
+            }
+            while (Clock::now() < deadline)
+            {
+                std::this_thread::yield();
+            }
+        }
+        now = Clock::now();
+        deadline += period;
+
+        double jitter = std::fabs(std::chrono::duration<double>(now - lastFrameEnd - period).count());
+        if (jitter > JITTER_BOUND)
+        {
+            overBound++;
+        }
+        if (jitters.size() < JITTER_HISTORY)
+        {
+            jitters.push_back(float(jitter));
+        }
+        else
+        {
+            jitters[nextJitter] = float(jitter);
+            nextJitter = (nextJitter + 1) % JITTER_HISTORY;
+        }
+    }
+
+    lastFrameEnd = now;
+    frames++;
+}
+
+void FramePacer::report() const
+{
+    static const char *MODE_NAMES[] = {"fixed rate", "vsync", "uncapped"};
+    std::cout << "Frame pacing (" << MODE_NAMES[int(mode)] << ") : " << frames << " frames";
+    if (mode == PacingMode::FixedRate && !jitters.empty())
+    {
+        std::vector<float> sorted = jitters;
+        std::sort(sorted.begin(), sorted.end());
+        std::cout << ", " << missed << " missed deadlines"
+                  << ", jitter p50 " << sorted[sorted.size() / 2] * 1000 << " ms"
+                  << ", p99 " << sorted[sorted.size() * 99 / 100] * 1000 << " ms"
+                  << ", " << overBound << " frames over " << JITTER_BOUND * 1000 << " ms";
+    }
+    std::cout << std::endl;
+}
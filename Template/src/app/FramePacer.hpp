@@ -0,0 +1,50 @@
+#pragma once
+#include "app/AppOptions.hpp"
+#include <chrono>
+#include <vector>
+
+/* Spaces the frames of the main loop according to AppOptions::pacing.
+
+   Fixed-rate mode keeps absolute deadlines (start + n * period, so errors do
+   not accumulate), sleeps until SPIN_MARGIN before the deadline and spins the
+   rest, which keeps frame-time jitter under JITTER_BOUND on a desktop
+   scheduler. A frame finishing after its deadline is counted as missed and
+   the schedule restarts from it instead of bursting to catch up.
+   Unlike glfwWaitEventsTimeout, input events never cut the wait short : they
+   are queued and handled by the next glfwPollEvents. */
+class FramePacer
+{
+public:
+    /* Needs the current GL context : sets the swap interval */
+    FramePacer(const AppOptions &options, double defaultFramePeriod);
+
+    /* Waits for the end of the frame slot (fixed rate only) */
+    void endFrame();
+
+    /* After the loop slept on purpose (on-demand, minimized), starts a new schedule */
+    void restart();
+
+    /* Prints frames, missed deadlines and jitter percentiles */
+    void report() const;
+
+    unsigned long missedDeadlines() const { return missed; }
+
+    static const double SPIN_MARGIN;
+    static const double JITTER_BOUND;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    PacingMode mode;
+    Clock::duration period;
+    Clock::time_point deadline;
+    Clock::time_point lastFrameEnd;
+    bool started = false;
+
+    unsigned long frames = 0;
+    unsigned long missed = 0;
+    unsigned long overBound = 0;
+    /* Last frame-interval errors in seconds, for percentiles */
+    std::vector<float> jitters;
+    size_t nextJitter = 0;
+};
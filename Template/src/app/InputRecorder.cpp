@@ -0,0 +1,358 @@
+#include "app/InputRecorder.hpp"
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+/* File layout : header, then one record per event
+     header   "TDIR", version, window width and height, cursor x and y
+     record   type (uint8), frame (uint32), microseconds since the start
+              (uint32), then the payload of its type */
+static const char INPUT_MAGIC[4] = {'T', 'D', 'I', 'R'};
+static const uint32_t INPUT_VERSION = 1;
+
+enum class InputEvent : uint8_t
+{
+    Key,         /* int32 key, int32 scancode, uint8 action, uint8 mods */
+    MouseButton, /* uint8 button, uint8 action, uint8 mods, float64 cursor x, y */
+    CursorPos,   /* float64 x, y */
+    WindowSize,  /* int32 width, height */
+    End,         /* nothing : the frame the recording stopped at */
+    Scroll       /* float64 x offset, y offset, cursor x, y */
+};
+
+template <class T>
+static void writeValue(std::ostream &out, const T &value)
+{
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <class T>
+static bool readValue(std::istream &in, T &value)
+{
+    return bool(in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+/* The executable's callbacks */
+static GLFWkeyfun keyCallback = nullptr;
+static GLFWmousebuttonfun mouseButtonCallback = nullptr;
+static GLFWcursorposfun cursorPosCallback = nullptr;
+static GLFWwindowsizefun windowSizeCallback = nullptr;
+static GLFWscrollfun scrollCallback = nullptr;
+
+static bool recording = false;
+static bool replaying = false;
+static std::ofstream recordFile;
+static std::ifstream replayFile;
+static int currentFrame = 0;
+static double startTime = 0;
+static uint32_t recordedEvents = 0;
+
+/* Replay state : the next event read ahead, and what the window looks like */
+static InputEvent nextType = InputEvent::End;
+static uint32_t nextFrame = 0;
+static uint32_t nextTime = 0;
+static double cursorX = 0;
+static double cursorY = 0;
+static int windowWidth = 0;
+static int windowHeight = 0;
+
+static void writeHeader(InputEvent type)
+{
+    double elapsed = (glfwGetTime() - startTime) * 1e6;
+    writeValue(recordFile, type);
+    writeValue(recordFile, uint32_t(currentFrame));
+    writeValue(recordFile, uint32_t(elapsed));
+    recordedEvents++;
+}
+
+static void record_key_callback(GLFWwindow *window, int key, int scancode, int action, int mods)
+{
+    writeHeader(InputEvent::Key);
+    writeValue(recordFile, int32_t(key));
+    writeValue(recordFile, int32_t(scancode));
+    writeValue(recordFile, uint8_t(action));
+    writeValue(recordFile, uint8_t(mods));
+    if (keyCallback)
+    {
+        keyCallback(window, key, scancode, action, mods);
+    }
+}
+
+static void record_mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
+{
+    /* Callbacks read the cursor with glfwGetCursorPos, it has to be replayed too */
+    double xpos, ypos;
+    glfwGetCursorPos(window, &xpos, &ypos);
+    writeHeader(InputEvent::MouseButton);
+    writeValue(recordFile, uint8_t(button));
+    writeValue(recordFile, uint8_t(action));
+    writeValue(recordFile, uint8_t(mods));
+    writeValue(recordFile, xpos);
+    writeValue(recordFile, ypos);
+    if (mouseButtonCallback)
+    {
+        mouseButtonCallback(window, button, action, mods);
+    }
+}
+
+static void record_cursor_pos_callback(GLFWwindow *window, double xpos, double ypos)
+{
+    writeHeader(InputEvent::CursorPos);
+    writeValue(recordFile, xpos);
+    writeValue(recordFile, ypos);
+    if (cursorPosCallback)
+    {
+        cursorPosCallback(window, xpos, ypos);
+    }
+}
+
+static void record_window_size_callback(GLFWwindow *window, int width, int height)
+{
+    writeHeader(InputEvent::WindowSize);
+    writeValue(recordFile, int32_t(width));
+    writeValue(recordFile, int32_t(height));
+    if (windowSizeCallback)
+    {
+        windowSizeCallback(window, width, height);
+    }
+}
+
+static void record_scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
+{
+    /* Zooming reads the cursor position too */
+    double xpos, ypos;
+    glfwGetCursorPos(window, &xpos, &ypos);
+    writeHeader(InputEvent::Scroll);
+    writeValue(recordFile, xoffset);
+    writeValue(recordFile, yoffset);
+    writeValue(recordFile, xpos);
+    writeValue(recordFile, ypos);
+    if (scrollCallback)
+    {
+        scrollCallback(window, xoffset, yoffset);
+    }
+}
+
+static void readNext()
+{
+    if (!readValue(replayFile, nextType) || !readValue(replayFile, nextFrame) || !readValue(replayFile, nextTime))
+    {
+        /* Truncated recording : stop where it ends */
+        nextType = InputEvent::End;
+    }
+}
+
+/* Sends every event of frame `frame` to the executable's callbacks */
+static void replayEvents(GLFWwindow *window, int frame)
+{
+    while (nextType != InputEvent::End && nextFrame <= uint32_t(frame))
+    {
+        switch (nextType)
+        {
+        case InputEvent::Key:
+        {
+            int32_t key, scancode;
+            uint8_t action, mods;
+            readValue(replayFile, key);
+            readValue(replayFile, scancode);
+            readValue(replayFile, action);
+            readValue(replayFile, mods);
+            if (keyCallback)
+            {
+                keyCallback(window, key, scancode, action, mods);
+            }
+            break;
+        }
+        case InputEvent::MouseButton:
+        {
+            uint8_t button, action, mods;
+            readValue(replayFile, button);
+            readValue(replayFile, action);
+            readValue(replayFile, mods);
+            readValue(replayFile, cursorX);
+            readValue(replayFile, cursorY);
+            if (mouseButtonCallback)
+            {
+                mouseButtonCallback(window, button, action, mods);
+            }
+            break;
+        }
+        case InputEvent::CursorPos:
+            readValue(replayFile, cursorX);
+            readValue(replayFile, cursorY);
+            if (cursorPosCallback)
+            {
+                cursorPosCallback(window, cursorX, cursorY);
+            }
+            break;
+        case InputEvent::WindowSize:
+        {
+            int32_t width, height;
+            readValue(replayFile, width);
+            readValue(replayFile, height);
+            windowWidth = width;
+            windowHeight = height;
+            if (windowSizeCallback)
+            {
+                windowSizeCallback(window, width, height);
+            }
+            break;
+        }
+        case InputEvent::Scroll:
+        {
+            double xoffset, yoffset;
+            readValue(replayFile, xoffset);
+            readValue(replayFile, yoffset);
+            readValue(replayFile, cursorX);
+            readValue(replayFile, cursorY);
+            if (scrollCallback)
+            {
+                scrollCallback(window, xoffset, yoffset);
+            }
+            break;
+        }
+        case InputEvent::End:
+            break;
+        }
+        readNext();
+    }
+
+    if (nextType == InputEvent::End && nextFrame <= uint32_t(frame))
+    {
+        glfwSetWindowShouldClose(window, GLFW_TRUE);
+    }
+}
+
+static bool startRecording(GLFWwindow *window, const std::string &path)
+{
+    recordFile.open(path, std::ios::binary);
+    if (!recordFile)
+    {
+        std::cout << "Cannot write the input recording " << path << std::endl;
+        return false;
+    }
+
+    int width, height;
+    double xpos, ypos;
+    glfwGetWindowSize(window, &width, &height);
+    glfwGetCursorPos(window, &xpos, &ypos);
+    recordFile.write(INPUT_MAGIC, sizeof(INPUT_MAGIC));
+    writeValue(recordFile, INPUT_VERSION);
+    writeValue(recordFile, int32_t(width));
+    writeValue(recordFile, int32_t(height));
+    writeValue(recordFile, xpos);
+    writeValue(recordFile, ypos);
+
+    /* Recorded first, then passed on */
+    keyCallback = glfwSetKeyCallback(window, record_key_callback);
+    mouseButtonCallback = glfwSetMouseButtonCallback(window, record_mouse_button_callback);
+    cursorPosCallback = glfwSetCursorPosCallback(window, record_cursor_pos_callback);
+    windowSizeCallback = glfwSetWindowSizeCallback(window, record_window_size_callback);
+    scrollCallback = glfwSetScrollCallback(window, record_scroll_callback);
+    startTime = glfwGetTime();
+    recording = true;
+    return true;
+}
+
+static bool startReplay(GLFWwindow *window, const std::string &path)
+{
+    replayFile.open(path, std::ios::binary);
+    char magic[4];
+    uint32_t version;
+    int32_t width, height;
+    if (!replayFile || !replayFile.read(magic, sizeof(magic)) ||
+        std::string(magic, sizeof(magic)) != std::string(INPUT_MAGIC, sizeof(INPUT_MAGIC)) ||
+        !readValue(replayFile, version) || version != INPUT_VERSION || !readValue(replayFile, width) ||
+        !readValue(replayFile, height) || !readValue(replayFile, cursorX) || !readValue(replayFile, cursorY))
+    {
+        std::cout << "Cannot read the input recording " << path << std::endl;
+        return false;
+    }
+
+    /* The window's own input does not reach the executable anymore */
+    keyCallback = glfwSetKeyCallback(window, nullptr);
+    mouseButtonCallback = glfwSetMouseButtonCallback(window, nullptr);
+    cursorPosCallback = glfwSetCursorPosCallback(window, nullptr);
+    windowSizeCallback = glfwSetWindowSizeCallback(window, nullptr);
+    scrollCallback = glfwSetScrollCallback(window, nullptr);
+    startTime = glfwGetTime();
+    replaying = true;
+
+    /* Start from the recorded window size */
+    glfwGetWindowSize(window, &windowWidth, &windowHeight);
+    if ((width != windowWidth || height != windowHeight) && windowSizeCallback)
+    {
+        windowSizeCallback(window, width, height);
+    }
+    windowWidth = width;
+    windowHeight = height;
+
+    readNext();
+    replayEvents(window, 0);
+    return true;
+}
+
+bool installInputRecorder(GLFWwindow *window, const AppOptions &options)
+{
+    if (!options.replayInput.empty())
+    {
+        return startReplay(window, options.replayInput);
+    }
+    if (!options.recordInput.empty())
+    {
+        return startRecording(window, options.recordInput);
+    }
+    return true;
+}
+
+void inputFrame(GLFWwindow *window, int frame)
+{
+    currentFrame = frame;
+    if (replaying)
+    {
+        replayEvents(window, frame);
+    }
+}
+
+void stopInputRecorder()
+{
+    double elapsed = glfwGetTime() - startTime;
+    if (recording)
+    {
+        writeHeader(InputEvent::End);
+        recordFile.close();
+        std::cout << "Recorded " << recordedEvents - 1 << " input events over " << currentFrame << " frames ("
+                  << elapsed << " s)" << std::endl;
+        recording = false;
+    }
+    if (replaying)
+    {
+        std::cout << "Replayed " << currentFrame << " frames in " << elapsed << " s (recorded in "
+                  << nextTime * 1e-6 << " s)" << std::endl;
+        replayFile.close();
+        replaying = false;
+    }
+}
+
+void inputCursorPos(GLFWwindow *window, double *xpos, double *ypos)
+{
+    if (replaying)
+    {
+        *xpos = cursorX;
+        *ypos = cursorY;
+        return;
+    }
+    glfwGetCursorPos(window, xpos, ypos);
+}
+
+void inputWindowSize(GLFWwindow *window, int *width, int *height)
+{
+    if (replaying)
+    {
+        *width = windowWidth;
+        *height = windowHeight;
+        return;
+    }
+    glfwGetWindowSize(window, width, height);
+}
@@ -0,0 +1,28 @@
+#pragma once
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h"
+#include "app/AppOptions.hpp"
+
+/* Input recording and replay.
+   With --record FILE, every key, mouse button, cursor, scroll and resize
+   event is written to FILE with the frame it arrived in, before reaching
+   the executable's callbacks. With --replay FILE, the window's own input is
+   ignored and the recorded events are sent to the same callbacks at the
+   start of the same frames, as fast as the frames can be drawn ; the
+   window closes after the last recorded frame. */
+
+/* After the executable set its callbacks : wraps them for --record, or
+   detaches them and sends the events of frame 0 for --replay */
+bool installInputRecorder(GLFWwindow *window, const AppOptions &options);
+
+/* At every frame boundary, right after `frame` was incremented and before
+   polling the events of the next frame */
+void inputFrame(GLFWwindow *window, int frame);
+
+/* Writes the end of the recording, or reports the replay */
+void stopInputRecorder();
+
+/* glfwGetCursorPos and glfwGetWindowSize as the callbacks should see them :
+   the recorded values while replaying */
+void inputCursorPos(GLFWwindow *window, double *xpos, double *ypos);
+void inputWindowSize(GLFWwindow *window, int *width, int *height);
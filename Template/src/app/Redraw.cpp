@@ -0,0 +1,57 @@
+#include "app/Redraw.hpp"
+#include <atomic>
+
+static std::atomic<bool> dirty(true);
+static bool animating = false;
+static bool iconified = false;
+
+static void iconify_callback(GLFWwindow *window, int isIconified)
+{
+    (void)window;
+    iconified = isIconified == GLFW_TRUE;
+    dirty = true;
+}
+
+static void refresh_callback(GLFWwindow *window)
+{
+    (void)window;
+    dirty = true;
+}
+
+void installRedrawCallbacks(GLFWwindow *window)
+{
+    glfwSetWindowIconifyCallback(window, iconify_callback);
+    glfwSetWindowRefreshCallback(window, refresh_callback);
+}
+
+void requestRedraw()
+{
+    dirty = true;
+}
+
+void postRedraw()
+{
+    dirty = true;
+    glfwPostEmptyEvent();
+}
+
+void setAnimating(bool isAnimating)
+{
+    animating = isAnimating;
+}
+
+bool waitForRedraw(GLFWwindow *window, bool onDemand)
+{
+    bool waited = false;
+    while (!glfwWindowShouldClose(window) && (iconified || (onDemand && !dirty && !animating)))
+    {
+        glfwWaitEvents();
+        waited = true;
+    }
+    return waited;
+}
+
+void frameDrawn()
+{
+    dirty = false;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h"
+
+/* On-demand rendering.
+   Input callbacks call requestRedraw() when they change the scene, running
+   animations keep setAnimating(true), and waitForRedraw() blocks in
+   glfwWaitEvents until one of them asks for a frame. A minimized window
+   never draws, on-demand mode or not. */
+
+/* Watches iconify and refresh (expose) events of the window */
+void installRedrawCallbacks(GLFWwindow *window);
+
+void requestRedraw();
+/* Same from any thread (e.g. a worker that finished loading something) :
+   also wakes waitForRedraw() up */
+void postRedraw();
+void setAnimating(bool animating);
+
+/* Returns once a frame has to be drawn or the window should close,
+   true if it had to sleep for that */
+bool waitForRedraw(GLFWwindow *window, bool onDemand);
+
+/* To call after drawing : the scene is clean again */
+void frameDrawn();
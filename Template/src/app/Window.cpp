@@ -0,0 +1,61 @@
+#include "app/Window.hpp"
+#include <iostream>
+
+GLFWwindow *createWindow(const AppOptions &options, int width, int height, const char *title)
+{
+#ifdef __APPLE__
+    // We need to explicitly ask for a 3.3 context on Mac
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
+    if (options.headless)
+    {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifdef TD_HEADLESS_OSMESA
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+#endif
+    }
+    return glfwCreateWindow(width, height, title, nullptr, nullptr);
+}
+
+bool OffscreenTarget::create(int width, int height)
+{
+    targetWidth = width;
+    targetHeight = height;
+
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "Offscreen framebuffer is incomplete" << std::endl;
+        release();
+        return false;
+    }
+    return true;
+}
+
+void OffscreenTarget::bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+void OffscreenTarget::release()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (framebuffer)
+    {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colorBuffer);
+    }
+    framebuffer = 0;
+    colorBuffer = 0;
+}
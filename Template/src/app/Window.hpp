@@ -0,0 +1,29 @@
+#pragma once
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h"
+#include "glad/glad.h"
+#include "app/AppOptions.hpp"
+
+/* glfwCreateWindow with the hints every TD uses.
+   When headless the window is never shown, and with the OSMesa build of GLFW
+   (TD_HEADLESS_OSMESA) no window system is needed at all. */
+GLFWwindow *createWindow(const AppOptions &options, int width, int height, const char *title);
+
+/* Framebuffer object standing in for the window when headless.
+   create() leaves it bound, so the scene code draws into it unchanged. */
+class OffscreenTarget
+{
+public:
+    bool create(int width, int height);
+    void bind() const;
+    void release();
+
+    int width() const { return targetWidth; }
+    int height() const { return targetHeight; }
+
+private:
+    GLuint framebuffer = 0;
+    GLuint colorBuffer = 0;
+    int targetWidth = 0;
+    int targetHeight = 0;
+};
@@ -0,0 +1,158 @@
+#include "assets/BakedTextures.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static const char BAKED_MAGIC[4] = {'T', 'D', 'B', 'K'};
+static const uint32_t BAKED_VERSION = 1;
+
+template <class T>
+static void writeValue(std::ostream &out, const T &value)
+{
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <class T>
+static bool readValue(std::istream &in, T &value)
+{
+    return bool(in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+static std::string fileName(const std::string &path)
+{
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+static int levelSize(int size, uint32_t level)
+{
+    int levelSize = size >> level;
+    return levelSize > 0 ? levelSize : 1;
+}
+
+bool BakedTextures::open(const std::string &path)
+{
+    entries.clear();
+    std::ifstream in(path, std::ios::binary);
+    char magic[4];
+    uint32_t version = 0;
+    uint32_t count = 0;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, BAKED_MAGIC, sizeof(magic)) != 0 ||
+        !readValue(in, version) || version != BAKED_VERSION || !readValue(in, count))
+    {
+        return false;
+    }
+
+    entries.resize(count);
+    for (Entry &entry : entries)
+    {
+        uint32_t nameLength = 0;
+        if (!readValue(in, nameLength) || nameLength > 4096)
+        {
+            entries.clear();
+            return false;
+        }
+        entry.name.resize(nameLength);
+        in.read(&entry.name[0], nameLength);
+        if (!readValue(in, entry.hash) || !readValue(in, entry.width) || !readValue(in, entry.height) ||
+            !readValue(in, entry.levelCount) || !readValue(in, entry.offset))
+        {
+            entries.clear();
+            return false;
+        }
+    }
+    containerPath = path;
+    return true;
+}
+
+bool BakedTextures::read(const std::string &sourcePath, std::vector<Image> &levels) const
+{
+    if (entries.empty())
+    {
+        return false;
+    }
+    std::string name = fileName(sourcePath);
+    uint64_t hash = 0;
+    bool hashed = hashFile(sourcePath, hash);
+
+    const Entry *found = nullptr;
+    for (const Entry &entry : entries)
+    {
+        if (hashed ? entry.hash == hash : entry.name == name)
+        {
+            found = &entry;
+            break;
+        }
+    }
+    if (!found)
+    {
+        return false;
+    }
+
+    std::ifstream in(containerPath, std::ios::binary);
+    in.seekg(std::streamoff(found->offset));
+    levels.resize(found->levelCount);
+    for (uint32_t level = 0; level < found->levelCount; level++)
+    {
+        Image &image = levels[level];
+        image.width = levelSize(found->width, level);
+        image.height = levelSize(found->height, level);
+        image.pixels.resize(size_t(image.width) * image.height * 4);
+        in.read(reinterpret_cast<char *>(image.pixels.data()), std::streamsize(image.pixels.size()));
+    }
+    if (!in)
+    {
+        levels.clear();
+        return false;
+    }
+    return true;
+}
+
+void BakedTexturesWriter::add(const std::string &name, uint64_t hash, const std::vector<Image> &levels)
+{
+    BakedTextures::Entry entry;
+    entry.name = fileName(name);
+    entry.hash = hash;
+    entry.width = levels[0].width;
+    entry.height = levels[0].height;
+    entry.levelCount = uint32_t(levels.size());
+    /* Relative to the data section until write() knows the table size */
+    entry.offset = data.size();
+    entries.push_back(entry);
+    for (const Image &image : levels)
+    {
+        data.insert(data.end(), image.pixels.begin(), image.pixels.end());
+    }
+}
+
+bool BakedTexturesWriter::write(const std::string &path) const
+{
+    uint64_t tableSize = sizeof(BAKED_MAGIC) + sizeof(BAKED_VERSION) + sizeof(uint32_t);
+    for (const BakedTextures::Entry &entry : entries)
+    {
+        tableSize += sizeof(uint32_t) + entry.name.size() + sizeof(entry.hash) + sizeof(entry.width) +
+                     sizeof(entry.height) + sizeof(entry.levelCount) + sizeof(entry.offset);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cout << "Cannot write " << path << std::endl;
+        return false;
+    }
+    out.write(BAKED_MAGIC, sizeof(BAKED_MAGIC));
+    writeValue(out, BAKED_VERSION);
+    writeValue(out, uint32_t(entries.size()));
+    for (const BakedTextures::Entry &entry : entries)
+    {
+        writeValue(out, uint32_t(entry.name.size()));
+        out.write(entry.name.data(), std::streamsize(entry.name.size()));
+        writeValue(out, entry.hash);
+        writeValue(out, entry.width);
+        writeValue(out, entry.height);
+        writeValue(out, entry.levelCount);
+        writeValue(out, uint64_t(tableSize + entry.offset));
+    }
+    out.write(reinterpret_cast<const char *>(data.data()), std::streamsize(data.size()));
+    return bool(out);
+}
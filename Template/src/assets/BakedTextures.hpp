@@ -0,0 +1,51 @@
+#pragma once
+#include "assets/Image.hpp"
+#include "helpers/FileHash.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Pre-decoded textures written by the bake_assets tool (tools/).
+
+   The container holds, for every source image, its FNV-1a content hash, its
+   file name and its full mip chain in premultiplied RGBA8, level after level.
+   At runtime read() hashes the source file and returns the baked levels if
+   the content matches, so a modified image is decoded again rather than
+   shown stale ; without the source file, the name alone is trusted. */
+class BakedTextures
+{
+public:
+    /* Only reads the entry table */
+    bool open(const std::string &path);
+
+    /* Thread-safe, every call reads with its own stream */
+    bool read(const std::string &sourcePath, std::vector<Image> &levels) const;
+
+    size_t size() const { return entries.size(); }
+
+    struct Entry
+    {
+        std::string name;
+        uint64_t hash = 0;
+        int width = 0;
+        int height = 0;
+        uint32_t levelCount = 0;
+        uint64_t offset = 0;
+    };
+
+private:
+    std::string containerPath;
+    std::vector<Entry> entries;
+};
+
+/* Builds a container in memory, then writes it at once */
+class BakedTexturesWriter
+{
+public:
+    void add(const std::string &name, uint64_t hash, const std::vector<Image> &levels);
+    bool write(const std::string &path) const;
+
+private:
+    std::vector<BakedTextures::Entry> entries;
+    std::vector<uint8_t> data;
+};
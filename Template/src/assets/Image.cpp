@@ -0,0 +1,171 @@
+#include "assets/Image.hpp"
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <jpeglib.h>
+#include <png.h>
+
+static bool decodePng(const std::string &path, Image &out)
+{
+    png_image png;
+    memset(&png, 0, sizeof(png));
+    png.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_file(&png, path.c_str()))
+    {
+        std::cout << "Cannot decode " << path << " : " << png.message << std::endl;
+        return false;
+    }
+
+    png.format = PNG_FORMAT_RGBA;
+    out.width = int(png.width);
+    out.height = int(png.height);
+    out.pixels.resize(PNG_IMAGE_SIZE(png));
+    if (!png_image_finish_read(&png, nullptr, out.pixels.data(), 0, nullptr))
+    {
+        std::cout << "Cannot decode " << path << " : " << png.message << std::endl;
+        png_image_free(&png);
+        return false;
+    }
+    return true;
+}
+
+struct JpegError
+{
+    jpeg_error_mgr manager;
+    jmp_buf jump;
+};
+
+static void onJpegError(j_common_ptr info)
+{
+    char message[JMSG_LENGTH_MAX];
+    info->err->format_message(info, message);
+    std::cout << "Cannot decode JPEG : " << message << std::endl;
+    longjmp(reinterpret_cast<JpegError *>(info->err)->jump, 1);
+}
+
+static bool decodeJpeg(FILE *file, Image &out)
+{
+    jpeg_decompress_struct info;
+    JpegError error;
+    info.err = jpeg_std_error(&error.manager);
+    error.manager.error_exit = onJpegError;
+    if (setjmp(error.jump))
+    {
+        jpeg_destroy_decompress(&info);
+        return false;
+    }
+
+    jpeg_create_decompress(&info);
+    jpeg_stdio_src(&info, file);
+    jpeg_read_header(&info, TRUE);
+#ifdef JCS_EXTENSIONS
+    /* libjpeg-turbo writes the alpha channel itself */
+    info.out_color_space = JCS_EXT_RGBA;
+#else
+    info.out_color_space = JCS_RGB;
+#endif
+    jpeg_start_decompress(&info);
+
+    out.width = int(info.output_width);
+    out.height = int(info.output_height);
+    out.pixels.resize(size_t(out.width) * out.height * 4);
+    while (info.output_scanline < info.output_height)
+    {
+        JSAMPROW row = out.pixels.data() + size_t(info.output_scanline) * out.width * 4;
+        jpeg_read_scanlines(&info, &row, 1);
+#ifndef JCS_EXTENSIONS
+        /* RGB to RGBA in place, from the end of the row */
+        for (int x = out.width - 1; x >= 0; x--)
+        {
+            row[4 * x + 3] = 255;
+            row[4 * x + 2] = row[3 * x + 2];
+            row[4 * x + 1] = row[3 * x + 1];
+            row[4 * x] = row[3 * x];
+        }
+#endif
+    }
+
+    jpeg_finish_decompress(&info);
+    jpeg_destroy_decompress(&info);
+    return true;
+}
+
+bool decodeImage(const std::string &path, Image &out)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        std::cout << "Cannot open " << path << std::endl;
+        return false;
+    }
+
+    unsigned char signature[8] = {0};
+    size_t read = fread(signature, 1, sizeof(signature), file);
+    bool ok = false;
+    if (read == sizeof(signature) && png_sig_cmp(signature, 0, sizeof(signature)) == 0)
+    {
+        fclose(file);
+        return decodePng(path, out);
+    }
+    else if (read >= 2 && signature[0] == 0xff && signature[1] == 0xd8)
+    {
+        rewind(file);
+        ok = decodeJpeg(file, out);
+    }
+    else
+    {
+        std::cout << "Unknown image format : " << path << std::endl;
+    }
+    fclose(file);
+    return ok;
+}
+
+void premultiplyAlpha(Image &image)
+{
+    for (size_t i = 0; i < image.pixels.size(); i += 4)
+    {
+        unsigned alpha = image.pixels[i + 3];
+        for (size_t c = 0; c < 3; c++)
+        {
+            image.pixels[i + c] = uint8_t((image.pixels[i + c] * alpha + 127) / 255);
+        }
+    }
+}
+
+void buildMipmaps(const Image &base, std::vector<Image> &levels)
+{
+    const Image *previous = &base;
+    while (previous->width > 1 || previous->height > 1)
+    {
+        Image level;
+        level.width = std::max(previous->width / 2, 1);
+        level.height = std::max(previous->height / 2, 1);
+        level.pixels.resize(size_t(level.width) * level.height * 4);
+
+        for (int y = 0; y < level.height; y++)
+        {
+            /* Odd sizes : the last row/column is reused instead of read past */
+            int y0 = std::min(2 * y, previous->height - 1);
+            int y1 = std::min(2 * y + 1, previous->height - 1);
+            for (int x = 0; x < level.width; x++)
+            {
+                int x0 = std::min(2 * x, previous->width - 1);
+                int x1 = std::min(2 * x + 1, previous->width - 1);
+                const uint8_t *p00 = &previous->pixels[(size_t(y0) * previous->width + x0) * 4];
+                const uint8_t *p01 = &previous->pixels[(size_t(y0) * previous->width + x1) * 4];
+                const uint8_t *p10 = &previous->pixels[(size_t(y1) * previous->width + x0) * 4];
+                const uint8_t *p11 = &previous->pixels[(size_t(y1) * previous->width + x1) * 4];
+                uint8_t *target = &level.pixels[(size_t(y) * level.width + x) * 4];
+                for (int c = 0; c < 4; c++)
+                {
+                    target[c] = uint8_t((p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+                }
+            }
+        }
+
+        levels.push_back(std::move(level));
+        previous = &levels.back();
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* 8-bit RGBA pixels, rows from top to bottom */
+struct Image
+{
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+/* Decodes a PNG or JPEG file (chosen from its first bytes) */
+bool decodeImage(const std::string &path, Image &out);
+
+/* rgb *= a, so that filtering and blending (GL_ONE, GL_ONE_MINUS_SRC_ALPHA)
+   do not bleed the color of transparent pixels */
+void premultiplyAlpha(Image &image);
+
+/* Appends the levels below `base` down to 1x1, each a 2x2 box filter of the
+   previous one ; levels[0] is left to the caller */
+void buildMipmaps(const Image &base, std::vector<Image> &levels);
@@ -0,0 +1,97 @@
+#include "assets/SkylinePacker.hpp"
+#include <algorithm>
+
+SkylinePacker::SkylinePacker(int width, int height) : width(width), height(height)
+{
+    clear();
+}
+
+void SkylinePacker::clear()
+{
+    skyline.clear();
+    skyline.push_back(Segment{0, 0, width});
+}
+
+int SkylinePacker::fitAt(size_t i, int rectWidth, int rectHeight) const
+{
+    if (skyline[i].x + rectWidth > width)
+    {
+        return -1;
+    }
+    int y = 0;
+    int left = rectWidth;
+    for (size_t j = i; left > 0; j++)
+    {
+        y = std::max(y, skyline[j].y);
+        if (y + rectHeight > height)
+        {
+            return -1;
+        }
+        left -= skyline[j].width;
+    }
+    return y;
+}
+
+bool SkylinePacker::insert(int rectWidth, int rectHeight, int &x, int &y)
+{
+    size_t best = skyline.size();
+    int bestTop = 0;
+    int bestWidth = 0;
+    for (size_t i = 0; i < skyline.size(); i++)
+    {
+        int fitY = fitAt(i, rectWidth, rectHeight);
+        if (fitY < 0)
+        {
+            continue;
+        }
+        int top = fitY + rectHeight;
+        if (best == skyline.size() || top < bestTop || (top == bestTop && skyline[i].width < bestWidth))
+        {
+            best = i;
+            bestTop = top;
+            bestWidth = skyline[i].width;
+        }
+    }
+    if (best == skyline.size())
+    {
+        return false;
+    }
+
+    x = skyline[best].x;
+    y = bestTop - rectHeight;
+
+    /* The new segment covers [x, x + rectWidth) : shrink or drop what is under it */
+    skyline.insert(skyline.begin() + best, Segment{x, bestTop, rectWidth});
+    size_t i = best + 1;
+    while (i < skyline.size())
+    {
+        Segment &segment = skyline[i];
+        int covered = x + rectWidth - segment.x;
+        if (covered <= 0)
+        {
+            break;
+        }
+        if (covered < segment.width)
+        {
+            segment.x += covered;
+            segment.width -= covered;
+            break;
+        }
+        skyline.erase(skyline.begin() + i);
+    }
+
+    /* Merge neighbours at the same height */
+    for (size_t j = 0; j + 1 < skyline.size();)
+    {
+        if (skyline[j].y == skyline[j + 1].y)
+        {
+            skyline[j].width += skyline[j + 1].width;
+            skyline.erase(skyline.begin() + j + 1);
+        }
+        else
+        {
+            j++;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+/* Rectangle packing with the skyline bottom-left heuristic.
+   The top edge of what is already packed is kept as a list of horizontal
+   segments ; a new rectangle goes where its top ends lowest, ties broken by
+   the narrowest segment. */
+class SkylinePacker
+{
+public:
+    SkylinePacker(int width, int height);
+
+    /* False if the rectangle does not fit anymore */
+    bool insert(int width, int height, int &x, int &y);
+    void clear();
+
+private:
+    struct Segment
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    /* Lowest y where a rectangle of `width` can sit from segment i, -1 if none */
+    int fitAt(size_t i, int width, int height) const;
+
+    int width;
+    int height;
+    std::vector<Segment> skyline;
+};
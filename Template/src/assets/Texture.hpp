@@ -0,0 +1,23 @@
+#pragma once
+#include "glad/glad.h"
+#include <cstdint>
+
+typedef uint32_t TextureId;
+
+/* A loaded image : a whole GL texture, or a region of an atlas page */
+struct Texture
+{
+    GLuint id = 0; /* 0 until the upload */
+    int width = 0;
+    int height = 0;
+    bool failed = false;
+    /* The GL texture belongs to a TextureAtlas */
+    bool inAtlas = false;
+    /* Image corners in the GL texture */
+    float u0 = 0;
+    float v0 = 0;
+    float u1 = 1;
+    float v1 = 1;
+
+    bool ready() const { return id != 0; }
+};
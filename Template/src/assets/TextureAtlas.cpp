@@ -0,0 +1,106 @@
+#include "assets/TextureAtlas.hpp"
+#include <algorithm>
+
+/* Mip levels stop where the padding would shrink below a pixel */
+static const int ATLAS_MAX_LEVEL = 2;
+
+TextureAtlas::Page &TextureAtlas::newPage()
+{
+    pages.push_back(Page());
+    Page &page = pages.back();
+
+    /* Cleared once, so that mipmaps never average uninitialized texels */
+    std::vector<uint8_t> transparent(size_t(PAGE_SIZE) * PAGE_SIZE * 4, 0);
+    glGenTextures(1, &page.texture);
+    glBindTexture(GL_TEXTURE_2D, page.texture);
+    for (int level = 0; level <= ATLAS_MAX_LEVEL; level++)
+    {
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, PAGE_SIZE >> level, PAGE_SIZE >> level, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, transparent.data());
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, ATLAS_MAX_LEVEL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return page;
+}
+
+bool TextureAtlas::add(const Image &image, Texture &texture)
+{
+    if (!fits(image.width, image.height))
+    {
+        return false;
+    }
+    int paddedWidth = image.width + 2 * PADDING;
+    int paddedHeight = image.height + 2 * PADDING;
+
+    Page *target = nullptr;
+    int x = 0;
+    int y = 0;
+    for (Page &page : pages)
+    {
+        if (page.packer.insert(paddedWidth, paddedHeight, x, y))
+        {
+            target = &page;
+            break;
+        }
+    }
+    if (!target)
+    {
+        target = &newPage();
+        target->packer.insert(paddedWidth, paddedHeight, x, y);
+    }
+
+    /* Border pixels extruded into the padding */
+    std::vector<uint8_t> padded(size_t(paddedWidth) * paddedHeight * 4);
+    for (int row = 0; row < paddedHeight; row++)
+    {
+        int sourceRow = std::min(std::max(row - PADDING, 0), image.height - 1);
+        for (int column = 0; column < paddedWidth; column++)
+        {
+            int sourceColumn = std::min(std::max(column - PADDING, 0), image.width - 1);
+            const uint8_t *source = &image.pixels[(size_t(sourceRow) * image.width + sourceColumn) * 4];
+            std::copy(source, source + 4, &padded[(size_t(row) * paddedWidth + column) * 4]);
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, target->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, paddedWidth, paddedHeight, GL_RGBA, GL_UNSIGNED_BYTE, padded.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    target->changed = true;
+
+    texture.id = target->texture;
+    texture.inAtlas = true;
+    texture.width = image.width;
+    texture.height = image.height;
+    texture.u0 = float(x + PADDING) / PAGE_SIZE;
+    texture.v0 = float(y + PADDING) / PAGE_SIZE;
+    texture.u1 = float(x + PADDING + image.width) / PAGE_SIZE;
+    texture.v1 = float(y + PADDING + image.height) / PAGE_SIZE;
+    return true;
+}
+
+void TextureAtlas::updateMipmaps()
+{
+    for (Page &page : pages)
+    {
+        if (page.changed)
+        {
+            glBindTexture(GL_TEXTURE_2D, page.texture);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            page.changed = false;
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void TextureAtlas::release()
+{
+    for (Page &page : pages)
+    {
+        glDeleteTextures(1, &page.texture);
+    }
+    pages.clear();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "glad/glad.h"
+#include "assets/Image.hpp"
+#include "assets/SkylinePacker.hpp"
+#include "assets/Texture.hpp"
+#include <vector>
+
+/* Small images packed into shared GL_RGBA8 pages, so that sprites using
+   them can be drawn together (see SpriteBatcher).
+   Every image is surrounded by PADDING pixels repeating its border : bilinear
+   filtering and the first mip levels never read a neighbour. */
+class TextureAtlas
+{
+public:
+    static const int PAGE_SIZE = 2048;
+    static const int PADDING = 4;
+
+    static bool fits(int width, int height)
+    {
+        return width + 2 * PADDING <= PAGE_SIZE && height + 2 * PADDING <= PAGE_SIZE;
+    }
+
+    /* Packs `image` in the first page with room (or a new one) and points
+       `texture` at it. On the GL thread. */
+    bool add(const Image &image, Texture &texture);
+
+    /* Rebuilds the mipmaps of the pages changed since the last call */
+    void updateMipmaps();
+
+    size_t pageCount() const { return pages.size(); }
+
+    /* Frees the pages, must be called while the context is alive */
+    void release();
+
+private:
+    struct Page
+    {
+        GLuint texture = 0;
+        SkylinePacker packer{PAGE_SIZE, PAGE_SIZE};
+        bool changed = false;
+    };
+
+    Page &newPage();
+
+    std::vector<Page> pages;
+};
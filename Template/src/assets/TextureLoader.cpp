@@ -0,0 +1,138 @@
+#include "assets/TextureLoader.hpp"
+#include "app/Redraw.hpp"
+#include "profiling/Profiler.hpp"
+
+TextureId TextureLoader::load(const std::string &path)
+{
+    return queue(path, nullptr);
+}
+
+TextureId TextureLoader::loadSprite(const std::string &path, TextureAtlas &atlas)
+{
+    return queue(path, &atlas);
+}
+
+TextureId TextureLoader::queue(const std::string &path, TextureAtlas *target)
+{
+    TextureId id = TextureId(textures.size());
+    textures.push_back(Texture());
+    inFlight++;
+
+    pool.submit([this, id, path, target]() {
+        PROFILE_ZONE("decodeTexture");
+        Decoded decoded;
+        decoded.id = id;
+        decoded.atlas = target;
+        bool ok = baked && baked->read(path, decoded.levels);
+        if (!ok)
+        {
+            decoded.levels.resize(1);
+            ok = decodeImage(path, decoded.levels[0]);
+            if (ok)
+            {
+                premultiplyAlpha(decoded.levels[0]);
+            }
+        }
+
+        if (!ok)
+        {
+            decoded.levels.clear();
+        }
+        else if (target && TextureAtlas::fits(decoded.levels[0].width, decoded.levels[0].height))
+        {
+            /* Atlas pages build their own mipmaps */
+            decoded.levels.resize(1);
+        }
+        else
+        {
+            decoded.atlas = nullptr;
+            if (decoded.levels.size() == 1)
+            {
+                buildMipmaps(decoded.levels[0], decoded.levels);
+            }
+        }
+        completed.push(std::move(decoded));
+        /* Wakes the render thread, even when it sleeps in on-demand mode */
+        postRedraw();
+    });
+    return id;
+}
+
+int TextureLoader::poll()
+{
+    if (!inFlight)
+    {
+        return 0;
+    }
+    PROFILE_ZONE("TextureLoader::poll");
+
+    arrived.clear();
+    completed.drain(arrived);
+    int uploaded = 0;
+    for (Decoded &decoded : arrived)
+    {
+        inFlight--;
+        Texture &texture = textures[decoded.id];
+        if (decoded.levels.empty())
+        {
+            texture.failed = true;
+            continue;
+        }
+
+        if (decoded.atlas && decoded.atlas->add(decoded.levels[0], texture))
+        {
+            decoded.atlas->updateMipmaps();
+        }
+        else
+        {
+            upload(decoded, texture);
+        }
+        uploaded++;
+    }
+    /* The decoded pixels are not needed anymore */
+    arrived.clear();
+    if (uploaded)
+    {
+        requestRedraw();
+    }
+    return uploaded;
+}
+
+void TextureLoader::upload(const Decoded &decoded, Texture &texture)
+{
+    texture.width = decoded.levels[0].width;
+    texture.height = decoded.levels[0].height;
+    glGenTextures(1, &texture.id);
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (size_t level = 0; level < decoded.levels.size(); level++)
+    {
+        const Image &image = decoded.levels[level];
+        glTexImage2D(GL_TEXTURE_2D, GLint(level), GL_RGBA8, image.width, image.height, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data());
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, GLint(decoded.levels.size() - 1));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void TextureLoader::release()
+{
+    pool.wait();
+    arrived.clear();
+    completed.drain(arrived);
+    arrived.clear();
+    inFlight = 0;
+    for (Texture &texture : textures)
+    {
+        /* Atlas pages are freed by their TextureAtlas */
+        if (texture.id && !texture.inAtlas)
+        {
+            glDeleteTextures(1, &texture.id);
+        }
+        texture = Texture();
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "glad/glad.h"
+#include "assets/BakedTextures.hpp"
+#include "assets/Image.hpp"
+#include "assets/Texture.hpp"
+#include "assets/TextureAtlas.hpp"
+#include "concurrency/CompletionQueue.hpp"
+#include "concurrency/ThreadPool.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Textures decoded in the background.
+   load() returns at once and queues the decoding and the mip chain on the
+   worker pool (pixels end up premultiplied by alpha) ; finished images go through a completion queue and poll(),
+   on the GL thread, uploads them. Until then texture(id).ready() is false
+   and the frame is drawn without it. */
+class TextureLoader
+{
+public:
+    explicit TextureLoader(ThreadPool &pool) : pool(pool) {}
+
+    TextureId load(const std::string &path);
+    /* Same, packed into `atlas` when small enough (no mipmaps of its own then) */
+    TextureId loadSprite(const std::string &path, TextureAtlas &atlas);
+
+    /* Images found in `container` (see BakedTextures) skip decoding */
+    void useBaked(const BakedTextures *container) { baked = container; }
+
+    /* Once per frame on the GL thread, returns the number of textures uploaded */
+    int poll();
+
+    const Texture &texture(TextureId id) const { return textures[id]; }
+    /* Textures still decoding */
+    size_t pending() const { return inFlight; }
+
+    /* Waits for the workers, then frees the GL textures */
+    void release();
+
+private:
+    struct Decoded
+    {
+        TextureId id;
+        TextureAtlas *atlas;
+        std::vector<Image> levels; /* empty on failure */
+    };
+
+    TextureId queue(const std::string &path, TextureAtlas *atlas);
+    void upload(const Decoded &decoded, Texture &texture);
+
+    ThreadPool &pool;
+    const BakedTextures *baked = nullptr;
+    CompletionQueue<Decoded> completed;
+    std::vector<Decoded> arrived;
+    std::vector<Texture> textures;
+    size_t inFlight = 0;
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include <mutex>
+#include <vector>
+
+/* Results pushed by worker threads, collected in batches by the render thread */
+template <class T>
+class CompletionQueue
+{
+public:
+    void push(T item)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.push_back(std::move(item));
+    }
+
+    /* Moves every completed item to the end of `out` */
+    void drain(std::vector<T> &out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (T &item : items)
+        {
+            out.push_back(std::move(item));
+        }
+        items.clear();
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<T> items;
+};
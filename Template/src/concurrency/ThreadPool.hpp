@@ -0,0 +1,38 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Fixed set of worker threads running submitted tasks in FIFO order */
+class ThreadPool
+{
+public:
+    /* 0 : one worker per core, minus the render thread */
+    explicit ThreadPool(unsigned threads = 0);
+    /* Finishes the queued tasks, then joins the workers */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void submit(std::function<void()> task);
+
+    /* Blocks until every submitted task has run */
+    void wait();
+
+    unsigned size() const { return unsigned(workers.size()); }
+
+private:
+    void run();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable allDone;
+    size_t running = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,325 @@
+#include "geometry/Triangulator.hpp"
+#include "profiling/Profiler.hpp"
+#include <algorithm>
+
+/* Twice the signed area of (a, b, c), positive when counter-clockwise */
+static double cross(const Vertex &a, const Vertex &b, const Vertex &c)
+{
+    return (double(b.posX) - a.posX) * (double(c.posY) - a.posY) - (double(b.posY) - a.posY) * (double(c.posX) - a.posX);
+}
+
+static bool samePosition(const Vertex &a, const Vertex &b)
+{
+    return a.posX == b.posX && a.posY == b.posY;
+}
+
+/* Inside or on the border of the counter-clockwise triangle (a, b, c) */
+static bool inTriangle(const Vertex &p, const Vertex &a, const Vertex &b, const Vertex &c)
+{
+    return cross(a, b, p) >= 0 && cross(b, c, p) >= 0 && cross(c, a, p) >= 0;
+}
+
+static bool segmentsCross(const Vertex &a, const Vertex &b, const Vertex &c, const Vertex &d)
+{
+    double abc = cross(a, b, c);
+    double abd = cross(a, b, d);
+    double cda = cross(c, d, a);
+    double cdb = cross(c, d, b);
+    return ((abc > 0 && abd < 0) || (abc < 0 && abd > 0)) && ((cda > 0 && cdb < 0) || (cda < 0 && cdb > 0));
+}
+
+static double signedArea(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &contour)
+{
+    double area = 0;
+    for (size_t i = 0, j = contour.size() - 1; i < contour.size(); j = i++)
+    {
+        const Vertex &a = vertices[contour[j]];
+        const Vertex &b = vertices[contour[i]];
+        area += double(a.posX) * b.posY - double(b.posX) * a.posY;
+    }
+    return area;
+}
+
+bool Triangulator::update(const std::vector<Vertex> &vertices, const std::vector<size_t> &holeStarts)
+{
+    if (vertices.size() == vertexCount && holeStarts.size() == holeCount)
+    {
+        changedFrom = triangles.size();
+        return false;
+    }
+
+    if (holeStarts.empty() && holeCount == 0 && vertices.size() == vertexCount + 1 && appendEar(vertices))
+    {
+        return true;
+    }
+
+    rebuild(vertices, holeStarts);
+    return true;
+}
+
+bool Triangulator::appendEar(const std::vector<Vertex> &vertices)
+{
+    size_t n = vertexCount;
+    if (n < 3 || outerArea == 0)
+    {
+        return false;
+    }
+
+    /* The closing edge (n - 1, 0) becomes (n - 1, n, 0) : the polygon gains
+       the triangle (a, b, c) if it lies outside of it */
+    const Vertex &a = vertices[n - 1];
+    const Vertex &b = vertices[n];
+    const Vertex &c = vertices[0];
+    double area = cross(a, b, c);
+    if (area == 0 || (area > 0) != (outerArea > 0))
+    {
+        return false;
+    }
+
+    /* No vertex inside the new ear, no edge crossing its two new sides */
+    for (size_t i = 1; i + 1 < n; i++)
+    {
+        const Vertex &p = vertices[i];
+        bool inside = area > 0 ? inTriangle(p, a, b, c) : inTriangle(p, c, b, a);
+        if (inside && !samePosition(p, a) && !samePosition(p, c))
+        {
+            return false;
+        }
+    }
+    for (size_t i = 0; i + 1 < n; i++)
+    {
+        const Vertex &p = vertices[i];
+        const Vertex &q = vertices[i + 1];
+        if (segmentsCross(p, q, a, b) || segmentsCross(p, q, b, c))
+        {
+            return false;
+        }
+    }
+
+    changedFrom = triangles.size();
+    triangles.push_back(uint32_t(n - 1));
+    triangles.push_back(uint32_t(n));
+    triangles.push_back(0);
+    outerArea += area;
+    vertexCount = n + 1;
+    return true;
+}
+
+void Triangulator::rebuild(const std::vector<Vertex> &vertices, const std::vector<size_t> &holeStarts)
+{
+    PROFILE_ZONE("Triangulator::rebuild");
+    triangles.clear();
+    changedFrom = 0;
+    vertexCount = vertices.size();
+    holeCount = holeStarts.size();
+
+    size_t outerEnd = holeStarts.empty() ? vertices.size() : std::min(holeStarts[0], vertices.size());
+    std::vector<uint32_t> ring;
+    for (size_t i = 0; i < outerEnd; i++)
+    {
+        ring.push_back(uint32_t(i));
+    }
+    outerArea = ring.size() >= 3 ? signedArea(vertices, ring) : 0;
+    if (outerArea == 0)
+    {
+        return;
+    }
+
+    /* Clipping works on a counter-clockwise ring, holes go clockwise */
+    bool clockwise = outerArea < 0;
+    if (clockwise)
+    {
+        std::reverse(ring.begin(), ring.end());
+    }
+
+    std::vector<std::vector<uint32_t>> holes;
+    for (size_t h = 0; h < holeStarts.size(); h++)
+    {
+        size_t end = h + 1 < holeStarts.size() ? holeStarts[h + 1] : vertices.size();
+        std::vector<uint32_t> hole;
+        for (size_t i = holeStarts[h]; i < std::min(end, vertices.size()); i++)
+        {
+            hole.push_back(uint32_t(i));
+        }
+        if (hole.size() < 3)
+        {
+            continue;
+        }
+        if (signedArea(vertices, hole) > 0)
+        {
+            std::reverse(hole.begin(), hole.end());
+        }
+        holes.push_back(hole);
+    }
+
+    /* Rightmost holes first, so that every bridge only crosses the ring */
+    auto maxX = [&](const std::vector<uint32_t> &contour) {
+        float x = vertices[contour[0]].posX;
+        for (uint32_t index : contour)
+        {
+            x = std::max(x, vertices[index].posX);
+        }
+        return x;
+    };
+    std::sort(holes.begin(), holes.end(), [&](const std::vector<uint32_t> &a, const std::vector<uint32_t> &b) {
+        return maxX(a) > maxX(b);
+    });
+    for (const std::vector<uint32_t> &hole : holes)
+    {
+        bridgeHole(vertices, ring, hole);
+    }
+
+    clipEars(vertices, ring);
+
+    if (clockwise)
+    {
+        /* Back to the winding of the input */
+        for (size_t i = 0; i < triangles.size(); i += 3)
+        {
+            std::swap(triangles[i + 1], triangles[i + 2]);
+        }
+    }
+}
+
+void Triangulator::bridgeHole(const std::vector<Vertex> &vertices, std::vector<uint32_t> &ring, const std::vector<uint32_t> &hole)
+{
+    /* M : rightmost hole vertex */
+    size_t m = 0;
+    for (size_t i = 1; i < hole.size(); i++)
+    {
+        if (vertices[hole[i]].posX > vertices[hole[m]].posX)
+        {
+            m = i;
+        }
+    }
+    const Vertex &M = vertices[hole[m]];
+
+    /* Closest ring edge hit by the ray from M towards +x ; P is its rightmost end */
+    double hitX = 0;
+    size_t p = ring.size();
+    for (size_t i = 0; i < ring.size(); i++)
+    {
+        const Vertex &a = vertices[ring[i]];
+        const Vertex &b = vertices[ring[(i + 1) % ring.size()]];
+        if ((a.posY > M.posY) == (b.posY > M.posY))
+        {
+            continue;
+        }
+        double x = a.posX + (double(M.posY) - a.posY) * (double(b.posX) - a.posX) / (double(b.posY) - a.posY);
+        if (x >= M.posX && (p == ring.size() || x < hitX))
+        {
+            hitX = x;
+            p = a.posX > b.posX ? i : (i + 1) % ring.size();
+        }
+    }
+    if (p == ring.size())
+    {
+        /* The hole is not inside the outer contour */
+        return;
+    }
+
+    /* Reflex ring vertices inside (M, I, P) would hide P from M : take the one
+       closest in angle to the ray instead */
+    Vertex I{float(hitX), M.posY};
+    Vertex P = vertices[ring[p]];
+    bool above = P.posY > M.posY;
+    const Vertex &t0 = M;
+    const Vertex &t1 = above ? I : P;
+    const Vertex &t2 = above ? P : I;
+    double bestTangent = -1;
+    for (size_t i = 0; i < ring.size(); i++)
+    {
+        const Vertex &v = vertices[ring[i]];
+        const Vertex &prev = vertices[ring[(i + ring.size() - 1) % ring.size()]];
+        const Vertex &next = vertices[ring[(i + 1) % ring.size()]];
+        if (i == p || cross(prev, v, next) >= 0 || v.posX < M.posX || !inTriangle(v, t0, t1, t2))
+        {
+            continue;
+        }
+        double tangent = std::abs(double(v.posY) - M.posY) / (double(v.posX) - M.posX + 1e-12);
+        if (bestTangent < 0 || tangent < bestTangent)
+        {
+            bestTangent = tangent;
+            p = i;
+        }
+    }
+
+    /* ..., P, M, hole..., M, P, ... */
+    std::vector<uint32_t> bridge;
+    bridge.reserve(hole.size() + 2);
+    for (size_t i = 0; i <= hole.size(); i++)
+    {
+        bridge.push_back(hole[(m + i) % hole.size()]);
+    }
+    bridge.push_back(ring[p]);
+    ring.insert(ring.begin() + p + 1, bridge.begin(), bridge.end());
+}
+
+void Triangulator::clipEars(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &ring)
+{
+    size_t count = ring.size();
+    std::vector<size_t> prev(count);
+    std::vector<size_t> next(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        prev[i] = (i + count - 1) % count;
+        next[i] = (i + 1) % count;
+    }
+    triangles.reserve(3 * (count - 2));
+
+    auto isEar = [&](size_t corner) {
+        const Vertex &a = vertices[ring[prev[corner]]];
+        const Vertex &b = vertices[ring[corner]];
+        const Vertex &c = vertices[ring[next[corner]]];
+        if (cross(a, b, c) <= 0)
+        {
+            return false;
+        }
+        for (size_t i = next[next[corner]]; i != prev[corner]; i = next[i])
+        {
+            const Vertex &p = vertices[ring[i]];
+            /* Bridge duplicates share the position of a corner */
+            if (inTriangle(p, a, b, c) && !samePosition(p, a) && !samePosition(p, b) && !samePosition(p, c))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    size_t corner = 0;
+    size_t remaining = count;
+    size_t tried = 0;
+    while (remaining > 3)
+    {
+        bool ear = isEar(corner);
+        if (ear || tried >= remaining)
+        {
+            /* No ear left means self-intersecting input : clip anyway so the
+               loop ends, degenerate triangles are dropped */
+            size_t a = prev[corner];
+            size_t c = next[corner];
+            if (cross(vertices[ring[a]], vertices[ring[corner]], vertices[ring[c]]) != 0)
+            {
+                triangles.push_back(ring[a]);
+                triangles.push_back(ring[corner]);
+                triangles.push_back(ring[c]);
+            }
+            next[a] = c;
+            prev[c] = a;
+            remaining--;
+            tried = 0;
+            corner = c;
+            continue;
+        }
+        corner = next[corner];
+        tried++;
+    }
+
+    if (cross(vertices[ring[prev[corner]]], vertices[ring[corner]], vertices[ring[next[corner]]]) != 0)
+    {
+        triangles.push_back(ring[prev[corner]]);
+        triangles.push_back(ring[corner]);
+        triangles.push_back(ring[next[corner]]);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "render/Vertex.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Ear-clipping triangulation of a polygon with holes, cached between frames.
+
+   The contours are consecutive ranges of the vertex array : the outer one
+   starts at 0 and each hole at one of `holeStarts`. Holes are bridged to the
+   outer contour (Eberly's method) and the resulting single ring is clipped.
+
+   When the only change is one vertex appended to the outer contour of a
+   polygon without holes, and that vertex adds an ear on the outside of the
+   closing edge, the new triangle is appended and the others are kept ;
+   any other change rebuilds the triangulation. */
+class Triangulator
+{
+public:
+    /* Brings indices() up to date, returns whether they changed */
+    bool update(const std::vector<Vertex> &vertices, const std::vector<size_t> &holeStarts = std::vector<size_t>());
+
+    /* Forces a rebuild on the next update(), e.g. after a vertex moved */
+    void invalidate() { vertexCount = 0; }
+
+    /* Triangles as vertex indices, in the winding of the outer contour */
+    const std::vector<uint32_t> &indices() const { return triangles; }
+    /* First entry of indices() that changed in the last update() */
+    size_t firstChanged() const { return changedFrom; }
+
+private:
+    bool appendEar(const std::vector<Vertex> &vertices);
+    void rebuild(const std::vector<Vertex> &vertices, const std::vector<size_t> &holeStarts);
+    void bridgeHole(const std::vector<Vertex> &vertices, std::vector<uint32_t> &ring, const std::vector<uint32_t> &hole);
+    void clipEars(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &ring);
+
+    std::vector<uint32_t> triangles;
+    size_t vertexCount = 0;
+    size_t holeCount = 0;
+    /* Twice the signed area of the outer contour */
+    double outerArea = 0;
+    size_t changedFrom = 0;
+};
@@ -0,0 +1,58 @@
+#include "helpers/FileHash.hpp"
+#include <fstream>
+#include <vector>
+
+/* Blocks read by hashFileSampled(), and their size */
+static const uint64_t SAMPLED_BLOCKS = 16;
+static const uint64_t SAMPLED_BLOCK_SIZE = 1 << 16;
+
+static void hashBytes(const char *bytes, size_t count, uint64_t &hash)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        hash ^= uint8_t(bytes[i]);
+        hash *= 1099511628211ull;
+    }
+}
+
+bool hashFile(const std::string &path, uint64_t &hash)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        return false;
+    }
+    hash = 14695981039346656037ull;
+    char chunk[1 << 16];
+    while (in)
+    {
+        in.read(chunk, sizeof(chunk));
+        hashBytes(chunk, size_t(in.gcount()), hash);
+    }
+    return true;
+}
+
+bool hashFileSampled(const std::string &path, uint64_t &hash)
+{
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+    {
+        return false;
+    }
+    uint64_t size = uint64_t(in.tellg());
+    hash = 14695981039346656037ull;
+    hashBytes(reinterpret_cast<const char *>(&size), sizeof(size), hash);
+
+    /* Block i starts at i / (SAMPLED_BLOCKS - 1) of the file : the first is
+       the head, the last ends on the tail */
+    std::vector<char> block(SAMPLED_BLOCK_SIZE);
+    uint64_t span = size > SAMPLED_BLOCK_SIZE ? size - SAMPLED_BLOCK_SIZE : 0;
+    for (uint64_t i = 0; i < SAMPLED_BLOCKS; i++)
+    {
+        in.clear();
+        in.seekg(std::streamoff(span * i / (SAMPLED_BLOCKS - 1)));
+        in.read(block.data(), std::streamsize(block.size()));
+        hashBytes(block.data(), size_t(in.gcount()), hash);
+    }
+    return true;
+}
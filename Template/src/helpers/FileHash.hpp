@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/* FNV-1a 64 of the whole file, streamed in chunks */
+bool hashFile(const std::string &path, uint64_t &hash);
+
+/* FNV-1a 64 of the size and of a few blocks (head, tail and evenly spaced
+   ones) : constant time whatever the size, for caches keyed on large files */
+bool hashFileSampled(const std::string &path, uint64_t &hash);
@@ -0,0 +1,63 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+/* 2D affine transform, stored as the first two rows of a 3x3 matrix :
+       | m[0] m[1] m[2] |
+       | m[3] m[4] m[5] |
+       |  0    0    1   |
+   so each row can be sent to a shader as a vec3. */
+struct Affine2
+{
+    float m[6];
+
+    static Affine2 identity()
+    {
+        return Affine2{{1, 0, 0, 0, 1, 0}};
+    }
+
+    static Affine2 translation(float x, float y)
+    {
+        return Affine2{{1, 0, x, 0, 1, y}};
+    }
+
+    static Affine2 scaling(float x, float y)
+    {
+        return Affine2{{x, 0, 0, 0, y, 0}};
+    }
+
+    /* Angle in degrees, like glRotatef */
+    static Affine2 rotation(float alpha)
+    {
+        float c = float(cos(alpha * M_PI / 180));
+        float s = float(sin(alpha * M_PI / 180));
+        return Affine2{{c, -s, 0, s, c, 0}};
+    }
+
+    /* (*this) * other : other is applied first, as with the GL matrix stack */
+    Affine2 operator*(const Affine2 &other) const
+    {
+        const float *a = m;
+        const float *b = other.m;
+        return Affine2{{a[0] * b[0] + a[1] * b[3], a[0] * b[1] + a[1] * b[4], a[0] * b[2] + a[1] * b[5] + a[2],
+                        a[3] * b[0] + a[4] * b[3], a[3] * b[1] + a[4] * b[4], a[3] * b[2] + a[4] * b[5] + a[5]}};
+    }
+
+    /* Assumes the transform is invertible (no zero scale) */
+    Affine2 inverse() const
+    {
+        float det = m[0] * m[4] - m[1] * m[3];
+        float a = m[4] / det;
+        float b = -m[1] / det;
+        float c = -m[3] / det;
+        float d = m[0] / det;
+        return Affine2{{a, b, -(a * m[2] + b * m[5]), c, d, -(c * m[2] + d * m[5])}};
+    }
+
+    void apply(float x, float y, float &outX, float &outY) const
+    {
+        outX = m[0] * x + m[1] * y + m[2];
+        outY = m[3] * x + m[4] * y + m[5];
+    }
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include "math/Affine2.hpp"
+#include <algorithm>
+
+/* Axis-aligned 2D box, empty until something is added to it */
+struct Bounds2
+{
+    float minX = 1;
+    float minY = 1;
+    float maxX = -1;
+    float maxY = -1;
+
+    static Bounds2 of(float minX, float minY, float maxX, float maxY)
+    {
+        Bounds2 bounds;
+        bounds.minX = minX;
+        bounds.minY = minY;
+        bounds.maxX = maxX;
+        bounds.maxY = maxY;
+        return bounds;
+    }
+
+    bool empty() const { return minX > maxX || minY > maxY; }
+
+    void add(float x, float y)
+    {
+        if (empty())
+        {
+            minX = maxX = x;
+            minY = maxY = y;
+            return;
+        }
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+    }
+
+    void add(const Bounds2 &other)
+    {
+        if (!other.empty())
+        {
+            add(other.minX, other.minY);
+            add(other.maxX, other.maxY);
+        }
+    }
+
+    /* Grown by `margin` on every side, e.g. half a point size */
+    Bounds2 expanded(float margin) const
+    {
+        return empty() ? *this : of(minX - margin, minY - margin, maxX + margin, maxY + margin);
+    }
+
+    bool contains(float x, float y) const
+    {
+        return x >= minX && x <= maxX && y >= minY && y <= maxY;
+    }
+
+    bool intersects(const Bounds2 &other) const
+    {
+        return !empty() && !other.empty() &&
+               minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+    }
+};
+
+/* Box around `local` once transformed, e.g. a shape under its world transform */
+inline Bounds2 transformBounds(const Affine2 &transform, const Bounds2 &local)
+{
+    Bounds2 bounds;
+    if (local.empty())
+    {
+        return bounds;
+    }
+    float x, y;
+    transform.apply(local.minX, local.minY, x, y);
+    bounds.add(x, y);
+    transform.apply(local.maxX, local.minY, x, y);
+    bounds.add(x, y);
+    transform.apply(local.minX, local.maxY, x, y);
+    bounds.add(x, y);
+    transform.apply(local.maxX, local.maxY, x, y);
+    bounds.add(x, y);
+    return bounds;
+}
@@ -0,0 +1,121 @@
+#include "math/Matrix4.hpp"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define TD_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+Matrix4 Matrix4::identity()
+{
+    return Matrix4{{1, 0, 0, 0,
+                    0, 1, 0, 0,
+                    0, 0, 1, 0,
+                    0, 0, 0, 1}};
+}
+
+Matrix4 Matrix4::translation(float x, float y, float z)
+{
+    Matrix4 result = identity();
+    result.m[12] = x;
+    result.m[13] = y;
+    result.m[14] = z;
+    return result;
+}
+
+Matrix4 Matrix4::rotation(float alpha, float x, float y, float z)
+{
+    float length = float(sqrt(x * x + y * y + z * z));
+    if (length == 0)
+    {
+        return identity();
+    }
+    x /= length;
+    y /= length;
+    z /= length;
+
+    float c = float(cos(alpha * M_PI / 180));
+    float s = float(sin(alpha * M_PI / 180));
+    float t = 1 - c;
+    return Matrix4{{t * x * x + c, t * x * y + s * z, t * x * z - s * y, 0,
+                    t * x * y - s * z, t * y * y + c, t * y * z + s * x, 0,
+                    t * x * z + s * y, t * y * z - s * x, t * z * z + c, 0,
+                    0, 0, 0, 1}};
+}
+
+Matrix4 Matrix4::scaling(float x, float y, float z)
+{
+    Matrix4 result = identity();
+    result.m[0] = x;
+    result.m[5] = y;
+    result.m[10] = z;
+    return result;
+}
+
+Matrix4 Matrix4::fromAffine2(const Affine2 &affine)
+{
+    const float *a = affine.m;
+    return Matrix4{{a[0], a[3], 0, 0,
+                    a[1], a[4], 0, 0,
+                    0, 0, 1, 0,
+                    a[2], a[5], 0, 1}};
+}
+
+Matrix4 Matrix4::operator*(const Matrix4 &other) const
+{
+    Matrix4 result;
+#ifdef TD_USE_SSE
+    /* Each result column is a combination of our four columns */
+    __m128 col0 = _mm_loadu_ps(m);
+    __m128 col1 = _mm_loadu_ps(m + 4);
+    __m128 col2 = _mm_loadu_ps(m + 8);
+    __m128 col3 = _mm_loadu_ps(m + 12);
+    for (int j = 0; j < 4; j++)
+    {
+        const float *b = other.m + 4 * j;
+        __m128 column = _mm_mul_ps(col0, _mm_set1_ps(b[0]));
+        column = _mm_add_ps(column, _mm_mul_ps(col1, _mm_set1_ps(b[1])));
+        column = _mm_add_ps(column, _mm_mul_ps(col2, _mm_set1_ps(b[2])));
+        column = _mm_add_ps(column, _mm_mul_ps(col3, _mm_set1_ps(b[3])));
+        _mm_storeu_ps(result.m + 4 * j, column);
+    }
+#else
+    for (int j = 0; j < 4; j++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            result.m[4 * j + i] = m[i] * other.m[4 * j] + m[4 + i] * other.m[4 * j + 1] +
+                                  m[8 + i] * other.m[4 * j + 2] + m[12 + i] * other.m[4 * j + 3];
+        }
+    }
+#endif
+    return result;
+}
+
+Affine2 Matrix4::toAffine2() const
+{
+    return Affine2{{m[0], m[4], m[12], m[1], m[5], m[13]}};
+}
+
+void transformPoints(const Affine2 &transform, const float *points, float *out, size_t count)
+{
+    const float *a = transform.m;
+    size_t i = 0;
+#ifdef TD_USE_SSE
+    /* Two interleaved points per register : (x0, y0, x1, y1) */
+    __m128 columnX = _mm_setr_ps(a[0], a[3], a[0], a[3]);
+    __m128 columnY = _mm_setr_ps(a[1], a[4], a[1], a[4]);
+    __m128 offset = _mm_setr_ps(a[2], a[5], a[2], a[5]);
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128 xy = _mm_loadu_ps(points + 2 * i);
+        __m128 xx = _mm_shuffle_ps(xy, xy, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 yy = _mm_shuffle_ps(xy, xy, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xx, columnX), _mm_mul_ps(yy, columnY)), offset);
+        _mm_storeu_ps(out + 2 * i, result);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        transform.apply(points[2 * i], points[2 * i + 1], out[2 * i], out[2 * i + 1]);
+    }
+}
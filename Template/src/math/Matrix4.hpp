@@ -0,0 +1,29 @@
+#pragma once
+#include "math/Affine2.hpp"
+#include <cstddef>
+
+/* 4x4 matrix in column-major order, the layout expected by glLoadMatrixf
+   and glUniformMatrix4fv(..., GL_FALSE, ...) */
+struct Matrix4
+{
+    float m[16];
+
+    static Matrix4 identity();
+    static Matrix4 translation(float x, float y, float z);
+    /* Angle in degrees around the (x, y, z) axis, like glRotatef */
+    static Matrix4 rotation(float alpha, float x, float y, float z);
+    static Matrix4 scaling(float x, float y, float z);
+    static Matrix4 fromAffine2(const Affine2 &affine);
+
+    /* (*this) * other, SSE when available */
+    Matrix4 operator*(const Matrix4 &other) const;
+
+    /* The xy part of the matrix, for per-instance data */
+    Affine2 toAffine2() const;
+
+    const float *data() const { return m; }
+};
+
+/* Applies an affine transform to `count` interleaved (x, y) points, SSE when available.
+   `out` may alias `points`. */
+void transformPoints(const Affine2 &transform, const float *points, float *out, size_t count);
@@ -0,0 +1,8 @@
+#include "math/MatrixStack.hpp"
+#include "glad/glad.h"
+
+void MatrixStack::load() const
+{
+    glMatrixMode(GL_MODELVIEW);
+    glLoadMatrixf(stack.back().data());
+}
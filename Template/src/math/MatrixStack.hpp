@@ -0,0 +1,38 @@
+#pragma once
+#include "math/Matrix4.hpp"
+#include <vector>
+
+/* CPU replacement for the fixed-function modelview stack.
+   Operations post-multiply the top matrix exactly like glTranslatef, glRotatef
+   and glScalef ; the result can be loaded with load(), sent as a uniform with
+   top().data() or flattened to per-instance data with top().toAffine2(). */
+class MatrixStack
+{
+public:
+    MatrixStack() : stack{Matrix4::identity()} {}
+
+    void push() { stack.push_back(stack.back()); }
+    void pop()
+    {
+        if (stack.size() > 1)
+        {
+            stack.pop_back();
+        }
+    }
+
+    void loadIdentity() { stack.back() = Matrix4::identity(); }
+    void loadMatrix(const Matrix4 &matrix) { stack.back() = matrix; }
+    void multiply(const Matrix4 &matrix) { stack.back() = stack.back() * matrix; }
+
+    void translate(float x, float y, float z) { multiply(Matrix4::translation(x, y, z)); }
+    void rotate(float alpha, float x, float y, float z) { multiply(Matrix4::rotation(alpha, x, y, z)); }
+    void scale(float x, float y, float z) { multiply(Matrix4::scaling(x, y, z)); }
+
+    const Matrix4 &top() const { return stack.back(); }
+
+    /* Replaces the GL modelview matrix by the top of the stack */
+    void load() const;
+
+private:
+    std::vector<Matrix4> stack;
+};
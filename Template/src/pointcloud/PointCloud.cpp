@@ -0,0 +1,423 @@
+#include "pointcloud/PointCloud.hpp"
+#include "helpers/FileHash.hpp"
+#include "profiling/Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+
+/* Points read from the source at once */
+static const size_t READ_CHUNK_POINTS = size_t(1) << 20;
+/* Points buffered per node before being appended to the .lod file */
+static const size_t BLOCK_POINTS = 4096;
+/* Points buffered over all nodes during the build, flushed past this */
+static const size_t BUILD_PENDING_POINTS = size_t(1) << 21;
+/* Leaves at this depth keep every point reaching them */
+static const uint32_t MAX_DEPTH = 14;
+/* Nodes read from disk per frame, the others show up in the next frames */
+static const int LOADS_PER_FRAME = 8;
+/* Splats never grow beyond this many times the point size */
+static const float MAX_SPLAT_SCALE = 4;
+
+static const char LOD_MAGIC[4] = {'T', 'D', 'P', 'C'};
+static const uint32_t LOD_VERSION = 3;
+
+template <class T>
+static void writeValue(std::ostream &out, const T &value)
+{
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <class T>
+static bool readValue(std::istream &in, T &value)
+{
+    return bool(in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+bool PointCloud::open(const std::string &path)
+{
+    release();
+    nodes.clear();
+
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+    {
+        std::cout << "Cannot open point cloud " << path << std::endl;
+        return false;
+    }
+    /* Size, modification time and sampled content : a source edited in place
+       must not reuse the tree, but startup must not read the whole file */
+    SourceKey key;
+    if (!hashFileSampled(path, key.hash))
+    {
+        std::cout << "Cannot read point cloud " << path << std::endl;
+        return false;
+    }
+    key.size = uint64_t(info.st_size);
+    key.modified = int64_t(info.st_mtime);
+
+    std::string lodPath = path + ".lod";
+    if (!loadIndex(lodPath, key))
+    {
+        std::cout << "Building levels of detail for " << path << "..." << std::endl;
+        if (!build(path, lodPath, key))
+        {
+            nodes.clear();
+            return false;
+        }
+    }
+
+    data.open(lodPath, std::ios::binary);
+    std::cout << "Point cloud : " << pointCount() << " points in " << nodes.size() << " nodes" << std::endl;
+    return bool(data);
+}
+
+bool PointCloud::build(const std::string &path, const std::string &lodPath, const SourceKey &key)
+{
+    PROFILE_ZONE("PointCloud::build");
+    std::ifstream source(path, std::ios::binary);
+    std::vector<Vertex> chunk(READ_CHUNK_POINTS);
+
+    /* First pass : bounds */
+    Bounds2 bounds;
+    while (source)
+    {
+        source.read(reinterpret_cast<char *>(chunk.data()), chunk.size() * sizeof(Vertex));
+        size_t count = size_t(source.gcount()) / sizeof(Vertex);
+        for (size_t i = 0; i < count; i++)
+        {
+            bounds.add(chunk[i].posX, chunk[i].posY);
+        }
+    }
+    if (bounds.empty())
+    {
+        std::cout << "Empty point cloud " << path << std::endl;
+        return false;
+    }
+
+    Node root;
+    root.centerX = (bounds.minX + bounds.maxX) / 2;
+    root.centerY = (bounds.minY + bounds.maxY) / 2;
+    root.halfSize = std::max(std::max(bounds.maxX - bounds.minX, bounds.maxY - bounds.minY) / 2 * 1.0001f, 1e-6f);
+    nodes.push_back(root);
+
+    std::ofstream out(lodPath, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cout << "Cannot write " << lodPath << std::endl;
+        return false;
+    }
+    /* Header, rewritten once the node table offset is known */
+    out.write(LOD_MAGIC, sizeof(LOD_MAGIC));
+    writeValue(out, LOD_VERSION);
+    writeValue(out, key.size);
+    writeValue(out, key.modified);
+    writeValue(out, key.hash);
+    writeValue(out, uint64_t(0));
+    writeValue(out, uint32_t(0));
+
+    /* Build-only state : grid occupancy and pending points of the nodes still
+       taking points. A node whose grid is full is finished : its points go to
+       the file and both are freed. Leaves at MAX_DEPTH take everything and
+       need no grid. */
+    static const size_t GRID_BYTES = NODE_GRID * NODE_GRID / 8;
+    std::vector<std::vector<uint8_t>> grids(1, std::vector<uint8_t>(GRID_BYTES, 0));
+    std::vector<std::vector<Vertex>> pending(1);
+    std::vector<uint32_t> withPending;
+    size_t pendingPoints = 0;
+
+    auto flush = [&](uint32_t id) {
+        std::vector<Vertex> &points = pending[id];
+        if (points.empty())
+        {
+            return;
+        }
+        nodes[id].blocks.push_back(Block{uint64_t(out.tellp()), uint32_t(points.size())});
+        out.write(reinterpret_cast<const char *>(points.data()), points.size() * sizeof(Vertex));
+        pendingPoints -= points.size();
+        /* Frees the capacity too, or flushed nodes would keep a block each */
+        std::vector<Vertex>().swap(points);
+    };
+
+    /* Second pass : every point goes down until a node has its grid cell free */
+    source.clear();
+    source.seekg(0);
+    while (source)
+    {
+        source.read(reinterpret_cast<char *>(chunk.data()), chunk.size() * sizeof(Vertex));
+        size_t count = size_t(source.gcount()) / sizeof(Vertex);
+        for (size_t i = 0; i < count; i++)
+        {
+            const Vertex &point = chunk[i];
+            uint32_t id = 0;
+            while (true)
+            {
+                nodes[id].subtreeCount++;
+                const Node &node = nodes[id];
+                float u = (point.posX - (node.centerX - node.halfSize)) / (2 * node.halfSize);
+                float v = (point.posY - (node.centerY - node.halfSize)) / (2 * node.halfSize);
+                int cellX = std::min(std::max(int(u * NODE_GRID), 0), NODE_GRID - 1);
+                int cellY = std::min(std::max(int(v * NODE_GRID), 0), NODE_GRID - 1);
+                int cell = cellY * NODE_GRID + cellX;
+
+                bool leaf = node.depth == MAX_DEPTH;
+                bool cellFree = !leaf && !grids[id].empty() && (grids[id][cell / 8] & (1 << (cell % 8))) == 0;
+                if (cellFree || leaf)
+                {
+                    if (!leaf)
+                    {
+                        grids[id][cell / 8] |= uint8_t(1 << (cell % 8));
+                    }
+                    nodes[id].pointCount++;
+                    if (pending[id].empty())
+                    {
+                        withPending.push_back(id);
+                    }
+                    pending[id].push_back(point);
+                    pendingPoints++;
+
+                    if (!leaf && nodes[id].pointCount == uint64_t(NODE_GRID * NODE_GRID))
+                    {
+                        flush(id);
+                        std::vector<uint8_t>().swap(grids[id]);
+                    }
+                    else if (pending[id].size() == BLOCK_POINTS)
+                    {
+                        flush(id);
+                    }
+                    else if (pendingPoints >= BUILD_PENDING_POINTS)
+                    {
+                        /* Bounded buffering, whatever the number of nodes */
+                        for (uint32_t pendingId : withPending)
+                        {
+                            flush(pendingId);
+                        }
+                        withPending.clear();
+                    }
+                    break;
+                }
+
+                int quadrant = (u >= 0.5f ? 1 : 0) + (v >= 0.5f ? 2 : 0);
+                if (node.children[quadrant] == NO_CHILD)
+                {
+                    Node child;
+                    child.halfSize = node.halfSize / 2;
+                    child.centerX = node.centerX + (quadrant & 1 ? child.halfSize : -child.halfSize);
+                    child.centerY = node.centerY + (quadrant & 2 ? child.halfSize : -child.halfSize);
+                    child.depth = node.depth + 1;
+                    uint32_t childId = uint32_t(nodes.size());
+                    nodes[id].children[quadrant] = childId;
+                    nodes.push_back(child);
+                    grids.push_back(std::vector<uint8_t>(child.depth == MAX_DEPTH ? 0 : GRID_BYTES, 0));
+                    pending.push_back(std::vector<Vertex>());
+                }
+                id = nodes[id].children[quadrant];
+            }
+        }
+    }
+    for (uint32_t id = 0; id < nodes.size(); id++)
+    {
+        flush(id);
+    }
+
+    /* Node table */
+    uint64_t tableOffset = uint64_t(out.tellp());
+    for (const Node &node : nodes)
+    {
+        writeValue(out, node.centerX);
+        writeValue(out, node.centerY);
+        writeValue(out, node.halfSize);
+        writeValue(out, node.depth);
+        for (uint32_t child : node.children)
+        {
+            writeValue(out, child);
+        }
+        writeValue(out, node.pointCount);
+        writeValue(out, node.subtreeCount);
+        writeValue(out, uint32_t(node.blocks.size()));
+        for (const Block &block : node.blocks)
+        {
+            writeValue(out, block.offset);
+            writeValue(out, block.count);
+        }
+    }
+
+    out.seekp(sizeof(LOD_MAGIC) + sizeof(LOD_VERSION) + sizeof(key.size) + sizeof(key.modified) + sizeof(key.hash));
+    writeValue(out, tableOffset);
+    writeValue(out, uint32_t(nodes.size()));
+    return bool(out);
+}
+
+bool PointCloud::loadIndex(const std::string &lodPath, const SourceKey &key)
+{
+    std::ifstream in(lodPath, std::ios::binary);
+    char magic[4];
+    uint32_t version = 0;
+    SourceKey stored;
+    uint64_t tableOffset = 0;
+    uint32_t nodeCount = 0;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, LOD_MAGIC, sizeof(magic)) != 0 ||
+        !readValue(in, version) || version != LOD_VERSION || !readValue(in, stored.size) || stored.size != key.size ||
+        !readValue(in, stored.modified) || stored.modified != key.modified ||
+        !readValue(in, stored.hash) || stored.hash != key.hash ||
+        !readValue(in, tableOffset) || !readValue(in, nodeCount) || nodeCount == 0)
+    {
+        return false;
+    }
+
+    in.seekg(std::streamoff(tableOffset));
+    nodes.resize(nodeCount);
+    for (Node &node : nodes)
+    {
+        uint32_t blockCount = 0;
+        bool ok = readValue(in, node.centerX) && readValue(in, node.centerY) && readValue(in, node.halfSize) &&
+                  readValue(in, node.depth);
+        for (uint32_t &child : node.children)
+        {
+            ok = ok && readValue(in, child);
+        }
+        ok = ok && readValue(in, node.pointCount) && readValue(in, node.subtreeCount) && readValue(in, blockCount);
+        node.blocks.resize(ok ? blockCount : 0);
+        for (Block &block : node.blocks)
+        {
+            ok = ok && readValue(in, block.offset) && readValue(in, block.count);
+        }
+        if (!ok)
+        {
+            nodes.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PointCloud::ensureLoaded(uint32_t id)
+{
+    Node &node = nodes[id];
+    if (node.loaded)
+    {
+        lru.splice(lru.begin(), lru, node.lruPosition);
+        return true;
+    }
+    if (loadsLeft <= 0)
+    {
+        deferred = true;
+        return false;
+    }
+    loadsLeft--;
+
+    PROFILE_ZONE("PointCloud::load");
+    std::vector<Vertex> points(size_t(node.pointCount));
+    size_t read = 0;
+    for (const Block &block : node.blocks)
+    {
+        data.clear();
+        data.seekg(std::streamoff(block.offset));
+        data.read(reinterpret_cast<char *>(points.data() + read), block.count * sizeof(Vertex));
+        read += block.count;
+    }
+
+    /* 16 bits over the node square : precision follows the level of detail */
+    ChunkFrame frame;
+    frame.originX = node.centerX;
+    frame.originY = node.centerY;
+    frame.halfExtent = node.halfSize;
+    node.buffer.setChunkFrame(frame);
+    node.buffer.sync(points);
+
+    node.loaded = true;
+    lru.push_front(id);
+    node.lruPosition = lru.begin();
+    cached += points.size();
+    return true;
+}
+
+void PointCloud::unload(uint32_t id)
+{
+    Node &node = nodes[id];
+    node.buffer.release();
+    node.loaded = false;
+    lru.erase(node.lruPosition);
+    cached -= size_t(node.pointCount);
+}
+
+void PointCloud::drawNode(uint32_t id, const View &view, float pointSize)
+{
+    const Node &node = nodes[id];
+    Bounds2 box = Bounds2::of(node.centerX - node.halfSize, node.centerY - node.halfSize,
+                              node.centerX + node.halfSize, node.centerY + node.halfSize);
+    if (!box.intersects(view.bounds) || !ensureLoaded(id))
+    {
+        return;
+    }
+    nodes[id].lastFrame = frame;
+
+    bool hasChildren = false;
+    for (uint32_t child : node.children)
+    {
+        hasChildren = hasChildren || child != NO_CHILD;
+    }
+    float cellPixels = 2 * node.halfSize / NODE_GRID * view.pixelsPerUnit;
+    bool refine = hasChildren && cellPixels > 1;
+
+    if (!refine && node.subtreeCount > node.pointCount)
+    {
+        /* Density splat : the points of the hidden subtree would land in the
+           same pixels, so this node's points stand in for them, larger and
+           accumulated additively according to how many each one represents */
+        float density = float(node.subtreeCount) / float(node.pointCount);
+        glPushAttrib(GL_CURRENT_BIT | GL_COLOR_BUFFER_BIT | GL_POINT_BIT);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+        glPointSize(pointSize * std::min(std::sqrt(density), MAX_SPLAT_SCALE));
+        GLfloat color[4];
+        glGetFloatv(GL_CURRENT_COLOR, color);
+        glColor4f(color[0], color[1], color[2], std::min(1.f, 0.25f * density));
+        node.buffer.draw(GL_POINTS);
+        glPopAttrib();
+        return;
+    }
+
+    node.buffer.draw(GL_POINTS);
+    if (refine)
+    {
+        for (uint32_t child : node.children)
+        {
+            if (child != NO_CHILD)
+            {
+                drawNode(child, view, pointSize);
+            }
+        }
+    }
+}
+
+void PointCloud::draw(const View &view, float pointSize)
+{
+    PROFILE_ZONE("PointCloud::draw");
+    if (nodes.empty())
+    {
+        return;
+    }
+
+    frame++;
+    loadsLeft = LOADS_PER_FRAME;
+    deferred = false;
+    glPointSize(pointSize);
+    drawNode(0, view, pointSize);
+
+    /* Evict what was not drawn this frame, oldest first */
+    while (cached > cacheBudget && !lru.empty() && nodes[lru.back()].lastFrame != frame)
+    {
+        unload(lru.back());
+    }
+}
+
+void PointCloud::release()
+{
+    while (!lru.empty())
+    {
+        unload(lru.back());
+    }
+    data.close();
+}
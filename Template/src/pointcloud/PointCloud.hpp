@@ -0,0 +1,97 @@
+#pragma once
+#include "render/VertexBuffer.hpp"
+#include "render/View.hpp"
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <string>
+#include <vector>
+
+/* Out-of-core point cloud with levels of detail.
+
+   The source file is a raw array of little-endian float32 (x, y) pairs. It is
+   streamed once, in chunks, into a quadtree written next to it (`.lod`) : each
+   node keeps at most one point per cell of a NODE_GRID x NODE_GRID grid over
+   its square, the others go down to its children, so every level is a
+   spatially uniform subsample of the level below. The tree is reused as long
+   as the source size, modification time and a hash of sampled blocks do not
+   change. The build only keeps the occupancy grids of unfinished nodes and a
+   bounded number of points.
+
+   Drawing walks the tree and stops refining once a node's grid cell is
+   smaller than a pixel. Nodes whose hidden subtree would pile several points
+   in the same pixels are drawn as additive density splats instead. Node
+   points are loaded on demand (a few nodes per frame) into 16-bit quantized
+   GPU buffers and evicted least-recently-used past the cache budget, so
+   memory depends on the view, not on the dataset. */
+class PointCloud
+{
+public:
+    bool open(const std::string &path);
+
+    void draw(const View &view, float pointSize);
+
+    /* Frees the GL buffers, must be called while the context is alive */
+    void release();
+
+    /* Largest number of points kept on the GPU */
+    void setCacheBudget(size_t points) { cacheBudget = points; }
+
+    uint64_t pointCount() const { return nodes.empty() ? 0 : nodes[0].subtreeCount; }
+    size_t cachedPoints() const { return cached; }
+
+    /* True when the last draw had to leave visible nodes for the next frames */
+    bool streaming() const { return deferred; }
+
+    static const int NODE_GRID = 128;
+
+private:
+    static const uint32_t NO_CHILD = 0xffffffff;
+
+    struct Block
+    {
+        uint64_t offset;
+        uint32_t count;
+    };
+
+    struct Node
+    {
+        float centerX = 0;
+        float centerY = 0;
+        float halfSize = 0;
+        uint32_t depth = 0;
+        uint32_t children[4] = {NO_CHILD, NO_CHILD, NO_CHILD, NO_CHILD};
+        uint64_t pointCount = 0;
+        uint64_t subtreeCount = 0;
+        std::vector<Block> blocks;
+
+        VertexBuffer<VertexQ16> buffer;
+        bool loaded = false;
+        std::list<uint32_t>::iterator lruPosition;
+        uint64_t lastFrame = 0;
+    };
+
+    /* What the .lod was built from */
+    struct SourceKey
+    {
+        uint64_t size = 0;
+        int64_t modified = 0;
+        uint64_t hash = 0;
+    };
+
+    bool build(const std::string &path, const std::string &lodPath, const SourceKey &key);
+    bool loadIndex(const std::string &lodPath, const SourceKey &key);
+
+    bool ensureLoaded(uint32_t id);
+    void unload(uint32_t id);
+    void drawNode(uint32_t id, const View &view, float pointSize);
+
+    std::vector<Node> nodes;
+    std::ifstream data;
+    std::list<uint32_t> lru;
+    size_t cached = 0;
+    size_t cacheBudget = size_t(8) << 20;
+    uint64_t frame = 0;
+    int loadsLeft = 0;
+    bool deferred = false;
+};
@@ -0,0 +1,127 @@
+#include "profiling/Profiler.hpp"
+
+#ifdef TD_PROFILING
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Zones kept per thread, the oldest ones are overwritten */
+static const size_t RING_CAPACITY = 1 << 18;
+
+struct ProfileEvent
+{
+    const char *name;
+    uint64_t start;
+    uint64_t end;
+};
+
+struct ThreadRing
+{
+    std::vector<ProfileEvent> events = std::vector<ProfileEvent>(RING_CAPACITY);
+    uint64_t written = 0;
+    int threadIndex = 0;
+};
+
+static std::mutex ringsMutex;
+static std::vector<std::unique_ptr<ThreadRing>> rings;
+
+static uint64_t nowInNanoseconds()
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count());
+}
+
+static ThreadRing &threadRing()
+{
+    /* Rings are owned by the registry so they outlive their thread */
+    thread_local ThreadRing *ring = nullptr;
+    if (!ring)
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.emplace_back(new ThreadRing());
+        ring = rings.back().get();
+        ring->threadIndex = int(rings.size());
+    }
+    return *ring;
+}
+
+ProfileZone::ProfileZone(const char *name) : name(name)
+{
+    /* Registers the thread's ring before the clock starts */
+    threadRing();
+    start = nowInNanoseconds();
+}
+
+ProfileZone::~ProfileZone()
+{
+    ThreadRing &ring = threadRing();
+    ring.events[ring.written % RING_CAPACITY] = ProfileEvent{name, start, nowInNanoseconds()};
+    ring.written++;
+}
+
+static uint64_t percentile(const std::vector<uint64_t> &sorted, double p)
+{
+    size_t index = size_t(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void exportProfile(const char *tracePath)
+{
+    std::lock_guard<std::mutex> lock(ringsMutex);
+
+    uint64_t origin = UINT64_MAX;
+    for (auto &ring : rings)
+    {
+        size_t count = size_t(std::min<uint64_t>(ring->written, RING_CAPACITY));
+        for (size_t i = 0; i < count; i++)
+        {
+            origin = std::min(origin, ring->events[i].start);
+        }
+    }
+
+    std::ofstream trace(tracePath);
+    trace << "{\"traceEvents\":[";
+    bool first = true;
+    std::map<std::string, std::vector<uint64_t>> durations;
+    for (auto &ring : rings)
+    {
+        size_t count = size_t(std::min<uint64_t>(ring->written, RING_CAPACITY));
+        for (size_t i = 0; i < count; i++)
+        {
+            const ProfileEvent &event = ring->events[i];
+            durations[event.name].push_back(event.end - event.start);
+
+            trace << (first ? "\n" : ",\n") << std::fixed << std::setprecision(3)
+                  << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->threadIndex
+                  << ",\"ts\":" << (event.start - origin) / 1000.0
+                  << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+            first = false;
+        }
+    }
+    trace << "\n]}\n";
+    std::cout << "Profile trace written to " << tracePath << std::endl;
+
+    std::cout << std::left << std::setw(24) << "zone" << std::right << std::setw(10) << "count"
+              << std::setw(12) << "p50 (us)" << std::setw(12) << "p95 (us)" << std::setw(12) << "p99 (us)" << std::endl;
+    for (auto &entry : durations)
+    {
+        std::vector<uint64_t> &sorted = entry.second;
+        std::sort(sorted.begin(), sorted.end());
+        std::cout << std::left << std::setw(24) << entry.first << std::right << std::setw(10) << sorted.size()
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(12) << percentile(sorted, 0.50) / 1000.0
+                  << std::setw(12) << percentile(sorted, 0.95) / 1000.0
+                  << std::setw(12) << percentile(sorted, 0.99) / 1000.0 << std::endl;
+    }
+}
+
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+
+/* Scoped-zone CPU profiler, enabled with the TD_PROFILING CMake option.
+
+     PROFILE_ZONE("drawForms");     times the enclosing scope
+     PROFILE_EXPORT("trace.json");  on exit : writes a Chrome trace (chrome://tracing
+                                    or ui.perfetto.dev) and prints p50/p95/p99 per zone
+
+   Every thread records into its own fixed-size ring buffer, so a zone costs
+   two clock reads and a store ; when disabled both macros expand to nothing. */
+
+#ifdef TD_PROFILING
+
+#include <cstdint>
+
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char *name);
+    ~ProfileZone();
+
+    ProfileZone(const ProfileZone &) = delete;
+    ProfileZone &operator=(const ProfileZone &) = delete;
+
+private:
+    const char *name;
+    uint64_t start;
+};
+
+/* Writes the trace and prints the summary, once worker threads are done */
+void exportProfile(const char *tracePath);
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_EXPORT(path) exportProfile(path)
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_EXPORT(path)
+
+#endif
@@ -0,0 +1,190 @@
+#include "render/Camera2D.hpp"
+#include "glad/glad.h"
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h"
+#include <algorithm>
+#include <cmath>
+
+const float Camera2D::MIN_ZOOM = 1.f / 64;
+const float Camera2D::MAX_ZOOM = 4096;
+const float Camera2D::ZOOM_STEP = 1.2f;
+const float Camera2D::SMOOTHING = 0.3f;
+
+/* Closer than this to the target, in pixels, the animation snaps onto it */
+static const float SNAP_DISTANCE_IN_PIXELS = 0.05f;
+
+void Camera2D::invalidate(int what)
+{
+    dirty |= what;
+    loaded = false;
+}
+
+void Camera2D::setViewport(int newWidth, int newHeight)
+{
+    newWidth = std::max(newWidth, 1);
+    newHeight = std::max(newHeight, 1);
+    if (newWidth != width || newHeight != height)
+    {
+        width = newWidth;
+        height = newHeight;
+        invalidate(PROJECTION_DIRTY);
+    }
+}
+
+void Camera2D::refresh() const
+{
+    if (!dirty)
+    {
+        return;
+    }
+    if (dirty & PROJECTION_DIRTY)
+    {
+        /* Same framing as the former glOrtho */
+        View framing = orthoView(width, height, viewSize);
+        halfWidth = framing.bounds.maxX;
+        halfHeight = framing.bounds.maxY;
+        projection = Affine2::scaling(1 / halfWidth, 1 / halfHeight);
+    }
+    if (dirty & VIEW_DIRTY)
+    {
+        viewTransform = Affine2::scaling(zoom, zoom) * Affine2::translation(-centerX, -centerY);
+    }
+
+    viewProjection = projection * viewTransform;
+    /* Window pixels (y down) to normalized device coordinates, then back to the world */
+    Affine2 windowToNdc{{2.f / width, 0, -1, 0, -2.f / height, 1}};
+    windowToWorld = viewProjection.inverse() * windowToNdc;
+
+    visible.bounds = Bounds2::of(centerX - halfWidth / zoom, centerY - halfHeight / zoom,
+                                 centerX + halfWidth / zoom, centerY + halfHeight / zoom);
+    visible.pixelsPerUnit = std::min(width, height) / viewSize * zoom;
+    dirty = 0;
+}
+
+void Camera2D::windowToEye(double xpos, double ypos, float &eyeX, float &eyeY) const
+{
+    refresh();
+    eyeX = float((2 * xpos / width - 1) * halfWidth);
+    eyeY = float((1 - 2 * ypos / height) * halfHeight);
+}
+
+bool Camera2D::mouseButton(int button, int action, double xpos, double ypos)
+{
+    if (button != GLFW_MOUSE_BUTTON_MIDDLE)
+    {
+        return false;
+    }
+    panning = action == GLFW_PRESS;
+    panX = xpos;
+    panY = ypos;
+    return true;
+}
+
+bool Camera2D::cursorMoved(double xpos, double ypos)
+{
+    if (!panning)
+    {
+        return false;
+    }
+
+    /* Dragging follows the cursor exactly, without easing : the world point
+       under the anchor moves under the cursor */
+    double positions[4] = {panX, panY, xpos, ypos};
+    float world[4];
+    toWorld(positions, world, 2);
+    float dx = world[2] - world[0];
+    float dy = world[3] - world[1];
+    panX = xpos;
+    panY = ypos;
+    centerX -= dx;
+    centerY -= dy;
+    targetX -= dx;
+    targetY -= dy;
+    invalidate(VIEW_DIRTY);
+    return true;
+}
+
+void Camera2D::scroll(double xpos, double ypos, double offset)
+{
+    /* The point under the cursor once the target is reached stays under it */
+    float eyeX, eyeY;
+    windowToEye(xpos, ypos, eyeX, eyeY);
+    float anchorX = targetX + eyeX / targetZoom;
+    float anchorY = targetY + eyeY / targetZoom;
+
+    targetZoom = std::min(std::max(targetZoom * float(pow(ZOOM_STEP, offset)), MIN_ZOOM), MAX_ZOOM);
+    targetX = anchorX - eyeX / targetZoom;
+    targetY = anchorY - eyeY / targetZoom;
+}
+
+bool Camera2D::update()
+{
+    if (centerX == targetX && centerY == targetY && zoom == targetZoom)
+    {
+        return false;
+    }
+
+    /* Zoom is eased on a log scale, so zooming in and out feel the same */
+    zoom *= float(pow(targetZoom / zoom, SMOOTHING));
+    centerX += (targetX - centerX) * SMOOTHING;
+    centerY += (targetY - centerY) * SMOOTHING;
+
+    float pixelsPerUnit = std::min(width, height) / viewSize * zoom;
+    float remaining = std::max(std::fabs(targetX - centerX), std::fabs(targetY - centerY)) * pixelsPerUnit;
+    float remainingZoom = std::fabs(targetZoom / zoom - 1) * std::max(width, height);
+    if (remaining < SNAP_DISTANCE_IN_PIXELS && remainingZoom < SNAP_DISTANCE_IN_PIXELS)
+    {
+        centerX = targetX;
+        centerY = targetY;
+        zoom = targetZoom;
+    }
+    invalidate(VIEW_DIRTY);
+    return true;
+}
+
+bool Camera2D::apply()
+{
+    if (loaded)
+    {
+        return false;
+    }
+    refresh();
+
+    /* Column-major 4x4, z mapped like glOrtho(..., -1, 1) */
+    const float *m = viewProjection.m;
+    float matrix[16] = {m[0], m[3], 0, 0, m[1], m[4], 0, 0, 0, 0, -1, 0, m[2], m[5], 0, 1};
+    glMatrixMode(GL_PROJECTION);
+    glLoadMatrixf(matrix);
+    glMatrixMode(GL_MODELVIEW);
+    loaded = true;
+    return true;
+}
+
+void Camera2D::toWorld(double &xpos, double &ypos) const
+{
+    refresh();
+    const float *m = windowToWorld.m;
+    double x = m[0] * xpos + m[1] * ypos + m[2];
+    double y = m[3] * xpos + m[4] * ypos + m[5];
+    xpos = x;
+    ypos = y;
+}
+
+void Camera2D::toWorld(const double *windowPositions, float *worldPositions, size_t count) const
+{
+    refresh();
+    const float *m = windowToWorld.m;
+    for (size_t i = 0; i < 2 * count; i += 2)
+    {
+        double x = windowPositions[i];
+        double y = windowPositions[i + 1];
+        worldPositions[i] = float(m[0] * x + m[1] * y + m[2]);
+        worldPositions[i + 1] = float(m[3] * x + m[4] * y + m[5]);
+    }
+}
+
+const View &Camera2D::view() const
+{
+    refresh();
+    return visible;
+}
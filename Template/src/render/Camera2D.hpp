@@ -0,0 +1,90 @@
+#pragma once
+#include "math/Affine2.hpp"
+#include "render/View.hpp"
+#include <cstddef>
+
+/* Orthographic 2D camera replacing the glOrtho of onWindowResized().
+   Without pan or zoom it shows the same framing : the smallest side of the
+   window spans `viewSize` world units around the origin. The view (pan and
+   zoom) and the projection (window size) are cached separately, with their
+   product and its inverse ; a change only recomputes what depends on it,
+   and the GL projection matrix is only reloaded when it changed.
+
+   The wheel zooms on the point under the cursor and the middle button drags
+   the view. Zooming eases towards its target, by a fixed fraction per frame
+   so that replayed inputs give the same frames. */
+class Camera2D
+{
+public:
+    explicit Camera2D(float viewSize = 2) : viewSize(viewSize) {}
+
+    /* From onWindowResized(), next to glViewport */
+    void setViewport(int width, int height);
+
+    /* Input, in window coordinates ; true when the event was used */
+    bool mouseButton(int button, int action, double xpos, double ypos);
+    bool cursorMoved(double xpos, double ypos);
+    void scroll(double xpos, double ypos, double offset);
+
+    /* Once per frame, before drawing : moves towards the zoom target, true
+       while it is still moving */
+    bool update();
+
+    /* Loads the projection if it changed since the last call, true if so
+       (pixelsPerUnit may have changed too) */
+    bool apply();
+
+    /* Window coordinates to world coordinates */
+    void toWorld(double &xpos, double &ypos) const;
+    /* Same for `count` interleaved (x, y) pairs, e.g. a cursor and its drag anchor */
+    void toWorld(const double *windowPositions, float *worldPositions, size_t count) const;
+
+    /* What is visible, for culling and level of detail */
+    const View &view() const;
+
+    /* Zoom limits, relative to the initial framing */
+    static const float MIN_ZOOM;
+    static const float MAX_ZOOM;
+    /* Zoom factor of one wheel notch */
+    static const float ZOOM_STEP;
+    /* Fraction of the remaining zoom done every frame */
+    static const float SMOOTHING;
+
+private:
+    enum Dirty
+    {
+        VIEW_DIRTY = 1,
+        PROJECTION_DIRTY = 2
+    };
+
+    void invalidate(int what);
+    void refresh() const;
+    /* Cursor position relative to the window center, in world units at zoom 1 */
+    void windowToEye(double xpos, double ypos, float &eyeX, float &eyeY) const;
+
+    float viewSize;
+    int width = 1;
+    int height = 1;
+
+    float centerX = 0;
+    float centerY = 0;
+    float zoom = 1;
+    float targetX = 0;
+    float targetY = 0;
+    float targetZoom = 1;
+
+    bool panning = false;
+    double panX = 0;
+    double panY = 0;
+
+    /* Caches, rebuilt by refresh() from the dirty flags */
+    mutable int dirty = VIEW_DIRTY | PROJECTION_DIRTY;
+    mutable float halfWidth = 1;
+    mutable float halfHeight = 1;
+    mutable Affine2 viewTransform = Affine2::identity();
+    mutable Affine2 projection = Affine2::identity();
+    mutable Affine2 windowToWorld = Affine2::identity();
+    mutable Affine2 viewProjection = Affine2::identity();
+    mutable View visible;
+    bool loaded = false;
+};
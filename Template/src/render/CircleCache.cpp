@@ -0,0 +1,71 @@
+#include "render/CircleCache.hpp"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+CircleCache::Tessellation &CircleCache::get(int segments)
+{
+    if (segments < 3)
+    {
+        segments = 3;
+    }
+
+    Tessellation &tessellation = tessellations[segments];
+    if (tessellation.points.empty())
+    {
+        tessellation.points.resize(2 * segments);
+        for (int i = 0; i < segments; i++)
+        {
+            double teta = (2 * M_PI * i) / segments;
+            tessellation.points[2 * i] = float(cos(teta));
+            tessellation.points[2 * i + 1] = float(sin(teta));
+        }
+    }
+    return tessellation;
+}
+
+const std::vector<float> &CircleCache::unitCircle(int segments)
+{
+    return get(segments).points;
+}
+
+void CircleCache::draw(float x, float y, float r, bool full, int segments)
+{
+    Tessellation &tessellation = get(segments);
+    if (!tessellation.buffer)
+    {
+        glGenBuffers(1, &tessellation.buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, tessellation.buffer);
+        glBufferData(GL_ARRAY_BUFFER, tessellation.points.size() * sizeof(float),
+                     tessellation.points.data(), GL_STATIC_DRAW);
+    }
+    else
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, tessellation.buffer);
+    }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, nullptr);
+
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glTranslatef(x, y, 0);
+    glScalef(r, r, 1);
+    glDrawArrays(full ? GL_TRIANGLE_FAN : GL_LINE_LOOP, 0, GLsizei(tessellation.points.size() / 2));
+    glPopMatrix();
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void CircleCache::release()
+{
+    for (auto &entry : tessellations)
+    {
+        if (entry.second.buffer)
+        {
+            glDeleteBuffers(1, &entry.second.buffer);
+        }
+    }
+    tessellations.clear();
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "glad/glad.h"
+#include <map>
+#include <vector>
+
+/* Number of segments used by drawCircle() */
+static const int DEFAULT_CIRCLE_SEGMENTS = 30;
+
+/* Unit circle tessellations, keyed by segment count.
+   Each table is computed once (exactly `segments` points, no accumulated
+   angle) and kept in a GPU buffer, then scaled and offset for every circle. */
+class CircleCache
+{
+public:
+    /* cos/sin pairs of the unit circle, interleaved as x0, y0, x1, y1... */
+    const std::vector<float> &unitCircle(int segments);
+
+    /* Filled circles are drawn as a triangle fan, outlines as a line loop */
+    void draw(float x, float y, float r, bool full, int segments = DEFAULT_CIRCLE_SEGMENTS);
+
+    /* Frees the GL buffers, must be called while the context is alive */
+    void release();
+
+private:
+    struct Tessellation
+    {
+        std::vector<float> points;
+        GLuint buffer = 0;
+    };
+
+    Tessellation &get(int segments);
+
+    std::map<int, Tessellation> tessellations;
+};
@@ -0,0 +1,45 @@
+#include "render/CircleLod.hpp"
+#include <algorithm>
+
+const int CircleLod::LEVELS[CircleLod::LEVEL_COUNT] = {8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256};
+
+void CircleLod::setViewport(int width, int height, float viewSize)
+{
+    setPixelsPerUnit(std::min(width, height) / viewSize);
+}
+
+void CircleLod::setTolerance(float pixels)
+{
+    for (int i = 0; i < LEVEL_COUNT; i++)
+    {
+        maxRadius[i] = float(pixels / (1 - cos(M_PI / LEVELS[i])));
+    }
+}
+
+int CircleLod::segments(float radius) const
+{
+    float pixels = radius * pixelsPerUnit;
+    for (int i = 0; i < LEVEL_COUNT; i++)
+    {
+        if (pixels <= maxRadius[i])
+        {
+            return LEVELS[i];
+        }
+    }
+    return LEVELS[LEVEL_COUNT - 1];
+}
+
+int CircleLod::segments(float radius, const Affine2 &transform) const
+{
+    return segments(radius * maxScale(transform));
+}
+
+float maxScale(const Affine2 &transform)
+{
+    const float *a = transform.m;
+    /* Lengths of the transformed unit axes, good enough for the similarity
+       transforms the TDs use */
+    float x = a[0] * a[0] + a[3] * a[3];
+    float y = a[1] * a[1] + a[4] * a[4];
+    return float(sqrt(std::max(x, y)));
+}
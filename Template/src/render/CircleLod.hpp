@@ -0,0 +1,38 @@
+#pragma once
+#include "math/Affine2.hpp"
+
+/* Chooses how many segments a circle needs from its radius in pixels.
+   A chord of a circle of radius r cut in N segments is at most
+   r * (1 - cos(PI / N)) away from the true circle : N is the smallest
+   level keeping that distance under the tolerance. Levels are a fixed
+   ladder, so zooming or resizing only picks another cached tessellation. */
+class CircleLod
+{
+public:
+    CircleLod() { setTolerance(0.5f); }
+
+    /* Pixels covered by one world unit, from the current ortho projection */
+    void setPixelsPerUnit(float pixels) { pixelsPerUnit = pixels; }
+
+    /* Same framing as onWindowResized() : the smallest side of the window spans viewSize */
+    void setViewport(int width, int height, float viewSize);
+
+    /* Largest allowed distance, in pixels, between the polygon and the circle */
+    void setTolerance(float pixels);
+
+    int segments(float radius) const;
+
+    /* `transform` is the one active when the circle is drawn */
+    int segments(float radius, const Affine2 &transform) const;
+
+    static const int LEVEL_COUNT = 11;
+    static const int LEVELS[LEVEL_COUNT];
+
+private:
+    float pixelsPerUnit = 1;
+    /* Largest pixel radius each level can draw within the tolerance */
+    float maxRadius[LEVEL_COUNT];
+};
+
+/* Largest factor by which `transform` stretches a length */
+float maxScale(const Affine2 &transform);
@@ -0,0 +1,52 @@
+#pragma once
+#include "render/Shape.hpp"
+#include <cstdint>
+#include <vector>
+#include <cstddef>
+
+/* Shapes recorded by one thread, without any GL call : one command per
+   batch of the InstancedRenderer (kind, filled, level of detail), holding
+   the instances of that batch. Worker threads each fill their own list,
+   then the GL thread merges them all into the renderer and draws. clear()
+   keeps the memory, so lists reused every frame stop allocating. */
+class DrawList
+{
+public:
+    struct Command
+    {
+        uint32_t batch;
+        std::vector<ShapeInstance> instances;
+    };
+
+    void add(uint32_t batch, const ShapeInstance &instance)
+    {
+        /* Consecutive shapes usually share a batch, and there are few batches */
+        if (last >= commandList.size() || commandList[last].batch != batch)
+        {
+            last = 0;
+            while (last < commandList.size() && commandList[last].batch != batch)
+            {
+                last++;
+            }
+            if (last == commandList.size())
+            {
+                commandList.push_back(Command{batch, {}});
+            }
+        }
+        commandList[last].instances.push_back(instance);
+    }
+
+    void clear()
+    {
+        for (Command &command : commandList)
+        {
+            command.instances.clear();
+        }
+    }
+
+    const std::vector<Command> &commands() const { return commandList; }
+
+private:
+    std::vector<Command> commandList;
+    size_t last = 0;
+};
@@ -0,0 +1,63 @@
+#include "render/IndexBuffer.hpp"
+#include <algorithm>
+
+/* Smallest storage allocated on the GPU, in indices */
+static const size_t MIN_INDEX_BUFFER_CAPACITY = 3072;
+
+void IndexBuffer::sync(const std::vector<uint32_t> &indices, size_t firstChanged)
+{
+    firstChanged = std::min(firstChanged, uploaded);
+    if (firstChanged == indices.size() && uploaded == indices.size())
+    {
+        return;
+    }
+
+    if (!buffer)
+    {
+        glGenBuffers(1, &buffer);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+
+    if (indices.size() > capacity)
+    {
+        size_t newCapacity = capacity ? capacity : MIN_INDEX_BUFFER_CAPACITY;
+        while (newCapacity < indices.size())
+        {
+            newCapacity *= 2;
+        }
+        capacity = newCapacity;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, capacity * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+        firstChanged = 0;
+    }
+
+    if (firstChanged < indices.size())
+    {
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, firstChanged * sizeof(uint32_t),
+                        (indices.size() - firstChanged) * sizeof(uint32_t), indices.data() + firstChanged);
+    }
+    uploaded = indices.size();
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void IndexBuffer::drawElements(GLenum mode) const
+{
+    if (!uploaded)
+    {
+        return;
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+    glDrawElements(mode, GLsizei(uploaded), GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void IndexBuffer::release()
+{
+    if (buffer)
+    {
+        glDeleteBuffers(1, &buffer);
+    }
+    buffer = 0;
+    capacity = 0;
+    uploaded = 0;
+}
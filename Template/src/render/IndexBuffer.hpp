@@ -0,0 +1,27 @@
+#pragma once
+#include "glad/glad.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* GPU copy of a growing index array (GL_ELEMENT_ARRAY_BUFFER). Like
+   VertexBuffer, sync() only uploads what changed since the previous call. */
+class IndexBuffer
+{
+public:
+    /* Uploads indices[firstChanged..] (everything if the buffer had to grow) */
+    void sync(const std::vector<uint32_t> &indices, size_t firstChanged);
+
+    /* glDrawElements over every index, with the vertex arrays already set up */
+    void drawElements(GLenum mode) const;
+
+    /* Frees the GL buffer, must be called while the context is alive */
+    void release();
+
+    size_t size() const { return uploaded; }
+
+private:
+    GLuint buffer = 0;
+    size_t capacity = 0;
+    size_t uploaded = 0;
+};
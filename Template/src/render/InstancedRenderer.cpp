@@ -0,0 +1,207 @@
+#include "render/InstancedRenderer.hpp"
+#include "profiling/Profiler.hpp"
+#include <cstddef>
+
+/* Appends a closed contour, as triangles (fan around its first point) or as line segments */
+static void appendContour(std::vector<float> &mesh, const std::vector<float> &contour, bool full)
+{
+    size_t count = contour.size() / 2;
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t next = (i + 1) % count;
+        if (full)
+        {
+            if (i == 0 || next == 0)
+            {
+                continue;
+            }
+            mesh.insert(mesh.end(), {contour[0], contour[1]});
+        }
+        mesh.insert(mesh.end(), {contour[2 * i], contour[2 * i + 1], contour[2 * next], contour[2 * next + 1]});
+    }
+}
+
+static std::vector<float> squareContour(float sx, float sy)
+{
+    return {-0.5f * sx, 0.5f * sy, -0.5f * sx, -0.5f * sy, 0.5f * sx, -0.5f * sy, 0.5f * sx, 0.5f * sy};
+}
+
+static std::vector<float> circleContour(const std::vector<float> &unit, float x, float y, float r)
+{
+    std::vector<float> contour(unit.size());
+    for (size_t i = 0; i < unit.size(); i += 2)
+    {
+        contour[i] = x + r * unit[i];
+        contour[i + 1] = y + r * unit[i + 1];
+    }
+    return contour;
+}
+
+uint32_t InstancedRenderer::batchKey(ShapeKind kind, bool full, int segments)
+{
+    return (uint32_t(kind) << 17) | (uint32_t(full) << 16) | uint32_t(segments);
+}
+
+void InstancedRenderer::buildMesh(ShapeKind kind, bool full, int segments, Batch &batch)
+{
+    batch.mode = full ? GL_TRIANGLES : GL_LINES;
+    const std::vector<float> &unit = circles.unitCircle(segments);
+
+    switch (kind)
+    {
+    case ShapeKind::Circle:
+        appendContour(batch.mesh, unit, full);
+        break;
+    case ShapeKind::Square:
+        appendContour(batch.mesh, squareContour(1, 1), full);
+        break;
+    case ShapeKind::RoundedSquare:
+    {
+        /* Two stretched squares and four corner circles, like TD03's immediate-mode rounded square */
+        float dist = 0.75f / 2;
+        appendContour(batch.mesh, squareContour(1.5f, 1), full);
+        appendContour(batch.mesh, squareContour(1, 1.5f), full);
+        appendContour(batch.mesh, circleContour(unit, -dist, dist, dist), full);
+        appendContour(batch.mesh, circleContour(unit, dist, dist, dist), full);
+        appendContour(batch.mesh, circleContour(unit, -dist, -dist, dist), full);
+        appendContour(batch.mesh, circleContour(unit, dist, -dist, dist), full);
+        break;
+    }
+    }
+}
+
+void InstancedRenderer::setupBatch(uint32_t key, Batch &batch)
+{
+    buildMesh(ShapeKind(key >> 17), ((key >> 16) & 1) != 0, int(key & 0xffff), batch);
+
+    glGenVertexArrays(1, &batch.vao);
+    glGenBuffers(1, &batch.meshBuffer);
+    glGenBuffers(1, &batch.instanceBuffer);
+    glBindVertexArray(batch.vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, batch.meshBuffer);
+    glBufferData(GL_ARRAY_BUFFER, batch.mesh.size() * sizeof(float), batch.mesh.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+    glBindBuffer(GL_ARRAY_BUFFER, batch.instanceBuffer);
+    GLsizei stride = sizeof(ShapeInstance);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(ShapeInstance, transform));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void *)(offsetof(ShapeInstance, transform) + 3 * sizeof(float)));
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(ShapeInstance, color));
+    glVertexAttribDivisor(3, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+uint32_t InstancedRenderer::batchOf(ShapeKind kind, bool full, const Affine2 &transform) const
+{
+    int segments = 0;
+    if (kind == ShapeKind::Circle)
+    {
+        segments = circleLod.segments(1, transform);
+    }
+    else if (kind == ShapeKind::RoundedSquare)
+    {
+        segments = circleLod.segments(0.75f / 2, transform);
+    }
+    return batchKey(kind, full, segments);
+}
+
+void InstancedRenderer::add(ShapeKind kind, bool full, const Affine2 &transform, float r, float g, float b, float a)
+{
+    batches[batchOf(kind, full, transform)].instances.push_back(ShapeInstance{transform, {r, g, b, a}});
+}
+
+void InstancedRenderer::record(DrawList &list, ShapeKind kind, bool full, const Affine2 &transform,
+                               float r, float g, float b, float a) const
+{
+    list.add(batchOf(kind, full, transform), ShapeInstance{transform, {r, g, b, a}});
+}
+
+void InstancedRenderer::merge(const DrawList &list)
+{
+    PROFILE_ZONE("InstancedRenderer::merge");
+    for (const DrawList::Command &command : list.commands())
+    {
+        if (!command.instances.empty())
+        {
+            std::vector<ShapeInstance> &instances = batches[command.batch].instances;
+            instances.insert(instances.end(), command.instances.begin(), command.instances.end());
+        }
+    }
+}
+
+void InstancedRenderer::flush()
+{
+    PROFILE_ZONE("InstancedRenderer::flush");
+    lastDrawCalls = 0;
+    lastVertices = 0;
+    if (shaders && programId == NO_PROGRAM)
+    {
+        programId = shaders->add("instanced.vert.glsl", "instanced.frag.glsl");
+    }
+    GLuint program = shaders ? shaders->program(programId) : 0;
+    if (!program)
+    {
+        for (auto &entry : batches)
+        {
+            entry.second.instances.clear();
+        }
+        return;
+    }
+
+    glUseProgram(program);
+    for (auto &entry : batches)
+    {
+        Batch &batch = entry.second;
+        if (batch.instances.empty())
+        {
+            continue;
+        }
+        if (!batch.vao)
+        {
+            setupBatch(entry.first, batch);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, batch.instanceBuffer);
+        if (batch.instances.size() > batch.instanceCapacity)
+        {
+            batch.instanceCapacity = batch.instances.size() * 2;
+        }
+        /* Orphan the previous storage so the driver never waits on last frame's draw */
+        glBufferData(GL_ARRAY_BUFFER, batch.instanceCapacity * sizeof(ShapeInstance), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, batch.instances.size() * sizeof(ShapeInstance), batch.instances.data());
+
+        glBindVertexArray(batch.vao);
+        glDrawArraysInstanced(batch.mode, 0, GLsizei(batch.mesh.size() / 2), GLsizei(batch.instances.size()));
+        lastDrawCalls++;
+        lastVertices += batch.mesh.size() / 2 * batch.instances.size();
+
+        batch.instances.clear();
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+}
+
+void InstancedRenderer::release()
+{
+    for (auto &entry : batches)
+    {
+        Batch &batch = entry.second;
+        if (batch.vao)
+        {
+            glDeleteVertexArrays(1, &batch.vao);
+            glDeleteBuffers(1, &batch.meshBuffer);
+            glDeleteBuffers(1, &batch.instanceBuffer);
+        }
+    }
+    batches.clear();
+}
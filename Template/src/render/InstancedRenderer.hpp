@@ -0,0 +1,76 @@
+#pragma once
+#include "glad/glad.h"
+#include "math/Affine2.hpp"
+#include "render/CircleCache.hpp"
+#include "render/CircleLod.hpp"
+#include "render/DrawList.hpp"
+#include "render/Shape.hpp"
+#include "render/ShaderManager.hpp"
+#include <map>
+#include <cstdint>
+#include <vector>
+#include <cstddef>
+
+/* Collects shapes during the frame and draws every (kind, filled, level of
+   detail) triple with a single glDrawArraysInstanced. The current GL modelview
+   and projection matrices still apply on top of each instance transform. */
+class InstancedRenderer
+{
+public:
+    /* Where the instancing program (assets/shaders/instanced.*.glsl) comes from ;
+       nothing is drawn without it */
+    void setShaders(ShaderManager &manager) { shaders = &manager; }
+
+    void add(ShapeKind kind, bool full, const Affine2 &transform, float r, float g, float b, float a = 1);
+
+    /* Same as add() into a list of another thread : safe to call from several
+       threads at once, as long as the level of detail is not changed meanwhile */
+    void record(DrawList &list, ShapeKind kind, bool full, const Affine2 &transform,
+                float r, float g, float b, float a = 1) const;
+
+    /* Appends the shapes of a list recorded by record(), before flush() */
+    void merge(const DrawList &list);
+
+    /* Draws and forgets everything added since the previous flush */
+    void flush();
+
+    /* Frees the GL objects, must be called while the context is alive */
+    void release();
+
+    /* Draw calls issued by the last flush */
+    size_t drawCalls() const { return lastDrawCalls; }
+    /* Vertices processed by the last flush, every instance counted */
+    size_t drawnVertices() const { return lastVertices; }
+
+    /* Picks the tessellation of circles and rounded corners ; keep its
+       viewport in sync with the projection */
+    CircleLod &lod() { return circleLod; }
+
+private:
+    struct Batch
+    {
+        std::vector<ShapeInstance> instances;
+        std::vector<float> mesh;
+        GLenum mode = GL_TRIANGLES;
+        GLuint vao = 0;
+        GLuint meshBuffer = 0;
+        GLuint instanceBuffer = 0;
+        size_t instanceCapacity = 0;
+    };
+
+    static uint32_t batchKey(ShapeKind kind, bool full, int segments);
+    /* Batch of a shape, from its kind and the level of detail its transform needs */
+    uint32_t batchOf(ShapeKind kind, bool full, const Affine2 &transform) const;
+
+    void setupBatch(uint32_t key, Batch &batch);
+    void buildMesh(ShapeKind kind, bool full, int segments, Batch &batch);
+
+    std::map<uint32_t, Batch> batches;
+    CircleCache circles;
+    CircleLod circleLod;
+    static const ProgramId NO_PROGRAM = 0xffffffff;
+    ShaderManager *shaders = nullptr;
+    ProgramId programId = NO_PROGRAM;
+    size_t lastDrawCalls = 0;
+    size_t lastVertices = 0;
+};
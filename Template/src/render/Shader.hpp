@@ -0,0 +1,13 @@
+#pragma once
+#include "glad/glad.h"
+
+/* Errors are printed on the standard output */
+
+/* Returns the shader object, 0 on error */
+GLuint compileShader(GLenum stage, const char *source);
+
+/* Links a program whose shaders are already attached */
+bool linkProgram(GLuint program);
+
+/* Compiles and links a vertex/fragment pair, 0 on error */
+GLuint buildProgram(const char *vertexSource, const char *fragmentSource);
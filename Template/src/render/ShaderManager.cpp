@@ -0,0 +1,363 @@
+#include "render/ShaderManager.hpp"
+#include "render/Shader.hpp"
+#include "helpers/RootDir.hpp"
+#include "profiling/Profiler.hpp"
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h"
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+/* GL 4.1 / ARB_get_program_binary, not part of the glad profile (3.3) */
+#define TD_GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define TD_GL_PROGRAM_BINARY_LENGTH 0x8741
+#define TD_GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+typedef void(APIENTRYP GetProgramBinaryProc)(GLuint, GLsizei, GLsizei *, GLenum *, void *);
+typedef void(APIENTRYP ProgramBinaryProc)(GLuint, GLenum, const void *, GLsizei);
+typedef void(APIENTRYP ProgramParameteriProc)(GLuint, GLenum, GLint);
+static GetProgramBinaryProc getProgramBinary = nullptr;
+static ProgramBinaryProc programBinary = nullptr;
+static ProgramParameteriProc programParameteri = nullptr;
+
+static const char BINARY_MAGIC[4] = {'T', 'D', 'P', 'B'};
+
+static uint64_t fnv1a(const std::string &text, uint64_t hash = 14695981039346656037ull)
+{
+    for (char c : text)
+    {
+        hash ^= uint8_t(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static std::string glString(GLenum name)
+{
+    const GLubyte *value = glGetString(name);
+    return value ? reinterpret_cast<const char *>(value) : "";
+}
+
+static void makeDirectory(const std::string &path)
+{
+#ifdef _WIN32
+    _mkdir(path.c_str());
+#else
+    mkdir(path.c_str(), 0755);
+#endif
+}
+
+ShaderManager::ShaderManager()
+    : shaderDirectory(std::string(ROOT_DIR) + "assets/shaders/"), cacheDirectory(std::string(ROOT_DIR) + "bin/shader_cache/")
+{
+}
+
+void ShaderManager::setDirectories(const std::string &shaders, const std::string &cache)
+{
+    shaderDirectory = shaders;
+    cacheDirectory = cache;
+}
+
+ProgramId ShaderManager::add(const std::string &vertexFile, const std::string &fragmentFile,
+                             const std::vector<std::string> &defines)
+{
+    Program entry;
+    entry.vertexFile = vertexFile;
+    entry.fragmentFile = fragmentFile;
+    entry.defines = defines;
+    programs.push_back(entry);
+    return ProgramId(programs.size() - 1);
+}
+
+GLuint ShaderManager::program(ProgramId id)
+{
+    Program &entry = programs[id];
+    if (!entry.built)
+    {
+        entry.program = build(entry);
+        entry.built = true;
+    }
+    return entry.program;
+}
+
+bool ShaderManager::readSource(const std::string &file, const std::vector<std::string> &defines, std::string &source) const
+{
+    std::ifstream in(shaderDirectory + file, std::ios::binary);
+    if (!in)
+    {
+        std::cout << "Cannot open shader " << shaderDirectory + file << std::endl;
+        return false;
+    }
+    std::stringstream content;
+    content << in.rdbuf();
+    source = content.str();
+
+    /* Defines go right after #version, which must stay the first statement */
+    size_t insertAt = 0;
+    if (source.compare(0, 8, "#version") == 0)
+    {
+        insertAt = source.find('\n');
+        insertAt = insertAt == std::string::npos ? source.size() : insertAt + 1;
+    }
+    std::string lines;
+    for (const std::string &define : defines)
+    {
+        lines += "#define " + define + "\n";
+    }
+    source.insert(insertAt, lines);
+    return true;
+}
+
+GLuint ShaderManager::build(const Program &entry)
+{
+    PROFILE_ZONE("ShaderManager::build");
+    std::string vertexSource;
+    std::string fragmentSource;
+    if (!readSource(entry.vertexFile, entry.defines, vertexSource) ||
+        !readSource(entry.fragmentFile, entry.defines, fragmentSource))
+    {
+        return 0;
+    }
+
+    loadBinaryFunctions();
+    if (!binarySupported)
+    {
+        return compileAndLink(entry, vertexSource, fragmentSource, std::vector<std::string>());
+    }
+
+    uint64_t key = 0;
+    std::string path = cachePath(vertexSource, fragmentSource, key);
+    GLuint program = loadBinary(path, key);
+    if (program)
+    {
+        return program;
+    }
+    program = compileAndLink(entry, vertexSource, fragmentSource, std::vector<std::string>());
+    if (program)
+    {
+        saveBinary(path, key, program);
+    }
+    return program;
+}
+
+std::string ShaderManager::cachePath(const std::string &vertexSource, const std::string &fragmentSource, uint64_t &key)
+{
+    /* Sources already contain the defines */
+    key = fnv1a(vertexSource);
+    key = fnv1a(std::string(1, '\0') + fragmentSource, key);
+    key = fnv1a(glString(GL_VENDOR) + '\n' + glString(GL_RENDERER) + '\n' + glString(GL_VERSION), key);
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return cacheDirectory + name;
+}
+
+int ShaderManager::reload(const std::vector<std::string> &changedFiles)
+{
+    PROFILE_ZONE("ShaderManager::reload");
+    recompiled.clear();
+    int swapped = 0;
+    for (Program &entry : programs)
+    {
+        bool affected = std::find(changedFiles.begin(), changedFiles.end(), entry.vertexFile) != changedFiles.end() ||
+                        std::find(changedFiles.begin(), changedFiles.end(), entry.fragmentFile) != changedFiles.end();
+        if (!affected || !entry.built)
+        {
+            continue;
+        }
+
+        std::string vertexSource;
+        std::string fragmentSource;
+        GLuint program = 0;
+        if (readSource(entry.vertexFile, entry.defines, vertexSource) &&
+            readSource(entry.fragmentFile, entry.defines, fragmentSource))
+        {
+            program = compileAndLink(entry, vertexSource, fragmentSource, changedFiles);
+        }
+        if (!program)
+        {
+            std::cout << "Keeping the previous " << entry.vertexFile << " / " << entry.fragmentFile << std::endl;
+            continue;
+        }
+
+        if (entry.program)
+        {
+            glDeleteProgram(entry.program);
+        }
+        entry.program = program;
+        swapped++;
+        std::cout << "Reloaded " << entry.vertexFile << " / " << entry.fragmentFile << std::endl;
+
+        if (binarySupported)
+        {
+            uint64_t key = 0;
+            std::string path = cachePath(vertexSource, fragmentSource, key);
+            saveBinary(path, key, program);
+        }
+    }
+    return swapped;
+}
+
+GLuint ShaderManager::stage(GLenum type, const std::string &file, const std::vector<std::string> &defines,
+                            const std::string &source, bool changed)
+{
+    std::string key = std::to_string(type) + ':' + file;
+    for (const std::string &define : defines)
+    {
+        key += '\n' + define;
+    }
+
+    auto cached = stages.find(key);
+    bool fresh = std::find(recompiled.begin(), recompiled.end(), key) != recompiled.end();
+    if (cached != stages.end() && (!changed || fresh))
+    {
+        return cached->second;
+    }
+
+    GLuint shader = compileShader(type, source.c_str());
+    stagesCompiled++;
+    if (!shader)
+    {
+        /* The cached stage, if any, stays the last good one */
+        return 0;
+    }
+    if (cached != stages.end())
+    {
+        glDeleteShader(cached->second);
+    }
+    stages[key] = shader;
+    recompiled.push_back(key);
+    return shader;
+}
+
+GLuint ShaderManager::compileAndLink(const Program &entry, const std::string &vertexSource,
+                                     const std::string &fragmentSource, const std::vector<std::string> &changedFiles)
+{
+    bool vertexChanged = std::find(changedFiles.begin(), changedFiles.end(), entry.vertexFile) != changedFiles.end();
+    bool fragmentChanged = std::find(changedFiles.begin(), changedFiles.end(), entry.fragmentFile) != changedFiles.end();
+    GLuint vertexShader = stage(GL_VERTEX_SHADER, entry.vertexFile, entry.defines, vertexSource, vertexChanged);
+    GLuint fragmentShader = stage(GL_FRAGMENT_SHADER, entry.fragmentFile, entry.defines, fragmentSource, fragmentChanged);
+    if (!vertexShader || !fragmentShader)
+    {
+        std::cout << "In " << entry.vertexFile << " / " << entry.fragmentFile << std::endl;
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    if (binarySupported)
+    {
+        programParameteri(program, TD_GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    bool linked = linkProgram(program);
+    glDetachShader(program, vertexShader);
+    glDetachShader(program, fragmentShader);
+    if (!linked)
+    {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void ShaderManager::loadBinaryFunctions()
+{
+    if (binaryChecked)
+    {
+        return;
+    }
+    binaryChecked = true;
+
+    getProgramBinary = reinterpret_cast<GetProgramBinaryProc>(glfwGetProcAddress("glGetProgramBinary"));
+    programBinary = reinterpret_cast<ProgramBinaryProc>(glfwGetProcAddress("glProgramBinary"));
+    programParameteri = reinterpret_cast<ProgramParameteriProc>(glfwGetProcAddress("glProgramParameteri"));
+    bool supported = (GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 1)) ||
+                     glfwExtensionSupported("GL_ARB_get_program_binary");
+    GLint formats = 0;
+    if (supported && getProgramBinary && programBinary && programParameteri)
+    {
+        /* Some drivers expose the functions without any format */
+        glGetIntegerv(TD_GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    }
+    binarySupported = formats > 0;
+    if (binarySupported)
+    {
+        makeDirectory(cacheDirectory);
+    }
+}
+
+GLuint ShaderManager::loadBinary(const std::string &path, uint64_t key)
+{
+    std::ifstream in(path, std::ios::binary);
+    char magic[4];
+    uint64_t storedKey = 0;
+    uint32_t format = 0;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0 ||
+        !in.read(reinterpret_cast<char *>(&storedKey), sizeof(storedKey)) || storedKey != key ||
+        !in.read(reinterpret_cast<char *>(&format), sizeof(format)))
+    {
+        return 0;
+    }
+    std::vector<char> binary((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    GLuint program = glCreateProgram();
+    programBinary(program, GLenum(format), binary.data(), GLsizei(binary.size()));
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        /* Refused by the driver : rebuilt from source and overwritten */
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void ShaderManager::saveBinary(const std::string &path, uint64_t key, GLuint program)
+{
+    GLint length = 0;
+    glGetProgramiv(program, TD_GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        return;
+    }
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    getProgramBinary(program, length, nullptr, &format, binary.data());
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    uint32_t storedFormat = format;
+    out.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    out.write(reinterpret_cast<const char *>(&key), sizeof(key));
+    out.write(reinterpret_cast<const char *>(&storedFormat), sizeof(storedFormat));
+    out.write(binary.data(), binary.size());
+    if (!out)
+    {
+        std::cout << "Cannot write the shader cache " << path << std::endl;
+    }
+}
+
+void ShaderManager::release()
+{
+    for (Program &entry : programs)
+    {
+        if (entry.program)
+        {
+            glDeleteProgram(entry.program);
+        }
+        entry.program = 0;
+        entry.built = false;
+    }
+    for (auto &cached : stages)
+    {
+        glDeleteShader(cached.second);
+    }
+    stages.clear();
+}
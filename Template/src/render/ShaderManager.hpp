@@ -0,0 +1,80 @@
+#pragma once
+#include "glad/glad.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef uint32_t ProgramId;
+
+/* GLSL programs built from files of assets/shaders/, with a program-binary cache.
+
+   A program is a vertex and a fragment file plus optional defines, inserted
+   after the #version line. Once linked, its binary (glGetProgramBinary) is
+   written to the cache directory under a key hashing both sources, the
+   defines and the GL vendor/renderer/version strings ; the next runs load it
+   back with glProgramBinary and compile nothing. Any mismatch (edited
+   source, new driver, binary refused) falls back to compiling the sources.
+   Without program binary support (GL 4.1 or ARB_get_program_binary), every
+   start compiles. */
+class ShaderManager
+{
+public:
+    ShaderManager();
+
+    void setDirectories(const std::string &shaderDirectory, const std::string &cacheDirectory);
+
+    /* Declares a program, built on the first call to program() */
+    ProgramId add(const std::string &vertexFile, const std::string &fragmentFile,
+                  const std::vector<std::string> &defines = std::vector<std::string>());
+
+    /* The GL program, 0 if it failed to build */
+    GLuint program(ProgramId id);
+
+    /* Rebuilds the programs using one of `changedFiles` (names relative to
+       the shader directory, e.g. from ShaderWatcher), between two frames.
+       Only the changed stages are recompiled ; a program that fails to
+       compile or link keeps its previous version. Returns the programs swapped. */
+    int reload(const std::vector<std::string> &changedFiles);
+
+    const std::string &directory() const { return shaderDirectory; }
+
+    /* Shader stages compiled from source so far (0 on a warm start) */
+    int compiledStages() const { return stagesCompiled; }
+
+    /* Frees the programs, must be called while the context is alive */
+    void release();
+
+private:
+    struct Program
+    {
+        std::string vertexFile;
+        std::string fragmentFile;
+        std::vector<std::string> defines;
+        GLuint program = 0;
+        bool built = false;
+    };
+
+    GLuint build(const Program &entry);
+    bool readSource(const std::string &file, const std::vector<std::string> &defines, std::string &source) const;
+    std::string cachePath(const std::string &vertexSource, const std::string &fragmentSource, uint64_t &key);
+    GLuint compileAndLink(const Program &entry, const std::string &vertexSource, const std::string &fragmentSource,
+                          const std::vector<std::string> &changedFiles);
+    GLuint stage(GLenum type, const std::string &file, const std::vector<std::string> &defines,
+                 const std::string &source, bool changed);
+
+    void loadBinaryFunctions();
+    GLuint loadBinary(const std::string &path, uint64_t key);
+    void saveBinary(const std::string &path, uint64_t key, GLuint program);
+
+    std::string shaderDirectory;
+    std::string cacheDirectory;
+    std::vector<Program> programs;
+    /* Compiled stages kept for reloads, by type, file and defines */
+    std::map<std::string, GLuint> stages;
+    /* Stages already recompiled by the current reload() */
+    std::vector<std::string> recompiled;
+    int stagesCompiled = 0;
+    bool binaryChecked = false;
+    bool binarySupported = false;
+};
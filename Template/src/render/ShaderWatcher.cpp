@@ -0,0 +1,98 @@
+#include "render/ShaderWatcher.hpp"
+#include "app/Redraw.hpp"
+#include <algorithm>
+#include <iostream>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+/* How often the watcher thread checks whether it has to stop */
+static const int STOP_CHECK_MILLISECONDS = 100;
+
+bool ShaderWatcher::start(const std::string &directory)
+{
+#ifdef __linux__
+    stop();
+    descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (descriptor < 0)
+    {
+        std::cout << "Shader hot reload unavailable : inotify_init1 failed" << std::endl;
+        return false;
+    }
+    /* Editors either rewrite the file or rename a temporary over it */
+    if (inotify_add_watch(descriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        std::cout << "Shader hot reload unavailable : cannot watch " << directory << std::endl;
+        close(descriptor);
+        descriptor = -1;
+        return false;
+    }
+    stopping = false;
+    thread = std::thread(&ShaderWatcher::run, this);
+    return true;
+#else
+    (void)directory;
+    return false;
+#endif
+}
+
+void ShaderWatcher::stop()
+{
+    if (thread.joinable())
+    {
+        stopping = true;
+        thread.join();
+    }
+#ifdef __linux__
+    if (descriptor >= 0)
+    {
+        close(descriptor);
+    }
+#endif
+    descriptor = -1;
+}
+
+void ShaderWatcher::poll(std::vector<std::string> &changed)
+{
+    changed.clear();
+    events.drain(changed);
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+}
+
+void ShaderWatcher::run()
+{
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    while (!stopping)
+    {
+        pollfd request{descriptor, POLLIN, 0};
+        if (::poll(&request, 1, STOP_CHECK_MILLISECONDS) <= 0)
+        {
+            continue;
+        }
+
+        bool any = false;
+        ssize_t length;
+        while ((length = read(descriptor, buffer, sizeof(buffer))) > 0)
+        {
+            for (ssize_t offset = 0; offset < length;)
+            {
+                const inotify_event *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                if (event->len > 0)
+                {
+                    events.push(std::string(event->name));
+                    any = true;
+                }
+                offset += sizeof(inotify_event) + event->len;
+            }
+        }
+        if (any)
+        {
+            postRedraw();
+        }
+    }
+#endif
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "concurrency/CompletionQueue.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Reports the files of a shader directory that were written or replaced.
+   On Linux a thread blocks on inotify and wakes the main loop (postRedraw),
+   so that changes are picked up at the next frame even in on-demand mode.
+   Elsewhere start() returns false and nothing is ever reported. */
+class ShaderWatcher
+{
+public:
+    ~ShaderWatcher() { stop(); }
+
+    bool start(const std::string &directory);
+    void stop();
+
+    /* File names (without directory) changed since the last call, each once */
+    void poll(std::vector<std::string> &changed);
+
+private:
+    void run();
+
+    CompletionQueue<std::string> events;
+    std::thread thread;
+    std::atomic<bool> stopping{false};
+    int descriptor = -1;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include "math/Affine2.hpp"
+#include "math/Bounds2.hpp"
+
+/* Shapes known by the instanced renderer, all centered on the origin :
+   Circle has a radius of 1, Square a side of 1 like drawSquare(), and
+   RoundedSquare (1.5 x 1 and 1 x 1.5 squares with corner circles of radius
+   0.375) a side of 1.5 */
+enum class ShapeKind
+{
+    Circle,
+    Square,
+    RoundedSquare
+};
+
+/* Extent of a shape before its instance transform */
+inline Bounds2 shapeBounds(ShapeKind kind)
+{
+    switch (kind)
+    {
+    case ShapeKind::Circle:
+        return Bounds2::of(-1, -1, 1, 1);
+    case ShapeKind::RoundedSquare:
+        return Bounds2::of(-0.75f, -0.75f, 0.75f, 0.75f);
+    default:
+        return Bounds2::of(-0.5f, -0.5f, 0.5f, 0.5f);
+    }
+}
+
+/* Per-instance data, read by the vertex shader with a divisor of 1 */
+struct ShapeInstance
+{
+    Affine2 transform;
+    float color[4];
+};
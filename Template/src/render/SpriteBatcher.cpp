@@ -0,0 +1,100 @@
+#include "render/SpriteBatcher.hpp"
+#include "profiling/Profiler.hpp"
+#include <algorithm>
+#include <cstddef>
+
+void SpriteBatcher::add(const Texture &texture, float x, float y, float width, float height, Rgba8 tint)
+{
+    if (!texture.ready())
+    {
+        return;
+    }
+    sprites.push_back(Sprite{texture.id, x, y, width, height, texture.u0, texture.v0, texture.u1, texture.v1, tint});
+}
+
+void SpriteBatcher::flush()
+{
+    PROFILE_ZONE("SpriteBatcher::flush");
+    calls = 0;
+    if (sprites.empty())
+    {
+        return;
+    }
+
+    /* Grouped by texture, in submission order inside a group */
+    std::stable_sort(sprites.begin(), sprites.end(), [](const Sprite &a, const Sprite &b) {
+        return a.texture < b.texture;
+    });
+
+    /* Two triangles per sprite ; v0 is the top row of the image */
+    vertices.clear();
+    vertices.reserve(sprites.size() * 6);
+    for (const Sprite &sprite : sprites)
+    {
+        SpriteVertex topLeft{sprite.x, sprite.y + sprite.height, sprite.u0, sprite.v0, sprite.tint};
+        SpriteVertex bottomLeft{sprite.x, sprite.y, sprite.u0, sprite.v1, sprite.tint};
+        SpriteVertex bottomRight{sprite.x + sprite.width, sprite.y, sprite.u1, sprite.v1, sprite.tint};
+        SpriteVertex topRight{sprite.x + sprite.width, sprite.y + sprite.height, sprite.u1, sprite.v0, sprite.tint};
+        vertices.push_back(topLeft);
+        vertices.push_back(bottomLeft);
+        vertices.push_back(bottomRight);
+        vertices.push_back(topLeft);
+        vertices.push_back(bottomRight);
+        vertices.push_back(topRight);
+    }
+
+    if (!buffer)
+    {
+        glGenBuffers(1, &buffer);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    /* Orphaned every frame : the driver does not wait for last frame's draws */
+    capacity = std::max(capacity, vertices.size());
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(SpriteVertex), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(SpriteVertex), vertices.data());
+
+    glPushAttrib(GL_CURRENT_BIT | GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT);
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    /* Loaded textures are premultiplied by alpha */
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(SpriteVertex), (void *)offsetof(SpriteVertex, x));
+    glTexCoordPointer(2, GL_FLOAT, sizeof(SpriteVertex), (void *)offsetof(SpriteVertex, u));
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(SpriteVertex), (void *)offsetof(SpriteVertex, tint));
+
+    size_t first = 0;
+    while (first < sprites.size())
+    {
+        size_t last = first + 1;
+        while (last < sprites.size() && sprites[last].texture == sprites[first].texture)
+        {
+            last++;
+        }
+        glBindTexture(GL_TEXTURE_2D, sprites[first].texture);
+        glDrawArrays(GL_TRIANGLES, GLint(first * 6), GLsizei((last - first) * 6));
+        calls++;
+        first = last;
+    }
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPopAttrib();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    sprites.clear();
+}
+
+void SpriteBatcher::release()
+{
+    if (buffer)
+    {
+        glDeleteBuffers(1, &buffer);
+    }
+    buffer = 0;
+    capacity = 0;
+}
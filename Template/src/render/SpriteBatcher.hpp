@@ -0,0 +1,47 @@
+#pragma once
+#include "glad/glad.h"
+#include "assets/Texture.hpp"
+#include "render/Vertex.hpp"
+#include <cstddef>
+#include <vector>
+
+/* Textured quads collected during the frame and drawn in flush() with one
+   glDrawArrays per GL texture : sprites whose images share an atlas page
+   (see TextureAtlas) cost a single draw call between them. */
+class SpriteBatcher
+{
+public:
+    /* Axis-aligned quad, (x, y) being its bottom-left corner */
+    void add(const Texture &texture, float x, float y, float width, float height,
+             Rgba8 tint = Rgba8{255, 255, 255, 255});
+
+    void flush();
+
+    /* Frees the GL buffer, must be called while the context is alive */
+    void release();
+
+    /* glDrawArrays issued by the last flush() */
+    int drawCalls() const { return calls; }
+
+private:
+    struct Sprite
+    {
+        GLuint texture;
+        float x, y, width, height;
+        float u0, v0, u1, v1;
+        Rgba8 tint;
+    };
+
+    struct SpriteVertex
+    {
+        float x, y;
+        float u, v;
+        Rgba8 tint;
+    };
+
+    std::vector<Sprite> sprites;
+    std::vector<SpriteVertex> vertices;
+    GLuint buffer = 0;
+    size_t capacity = 0;
+    int calls = 0;
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/* A point clicked by the user, in world coordinates.
+   Single precision is plenty for a view a few units wide. */
+struct Vertex
+{
+    float posX;
+    float posY;
+};
+
+/* Packed 8 bits per channel color */
+struct Rgba8
+{
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t a;
+};
+
+struct ColoredVertex
+{
+    float posX;
+    float posY;
+    Rgba8 color;
+};
+
+/* vertices[first, first + count) */
+struct VertexRange
+{
+    size_t first;
+    size_t count;
+};
@@ -0,0 +1,266 @@
+#pragma once
+#include "glad/glad.h"
+#include "render/IndexBuffer.hpp"
+#include "render/Vertex.hpp"
+#include "render/VertexFormat.hpp"
+#include <vector>
+#include <cstddef>
+
+/* GPU copy of a growing vertex array, stored in the layout of `Format`
+   (see VertexFormat.hpp). sync() only encodes and uploads the vertices added
+   since the previous call, and the whole array is drawn with a single
+   glDrawArrays. `Source` is Vertex, or ColoredVertex for colored formats.
+   A quantized format shares one frame over the whole buffer, which grows
+   with the farthest vertex : use one buffer per bounded tile (setChunkFrame),
+   as PointCloud does, rather than for unbounded input like clicks. */
+template <class Format = VertexF32, class Source = Vertex>
+class VertexBuffer
+{
+public:
+    typedef typename Format::Packed Packed;
+
+    /* Uploads vertices[size()..] (everything if the array shrank, or if a
+       quantized format needs a larger chunk frame) */
+    void sync(const std::vector<Source> &vertices);
+
+    /* Re-uploads vertices[index] after it was modified in place */
+    void update(const std::vector<Source> &vertices, size_t index);
+
+    void draw(GLenum mode) const { draw(mode, 0, uploaded); }
+    void draw(GLenum mode, size_t first, size_t count) const;
+    /* Several ranges with a single glMultiDrawArrays, e.g. the visible ones */
+    void draw(GLenum mode, const std::vector<VertexRange> &ranges) const;
+    /* Indexed draw, e.g. a triangulation of the vertices */
+    void draw(GLenum mode, const IndexBuffer &indices) const;
+
+    /* Frees the GL buffer, must be called while the context is alive */
+    void release();
+
+    size_t size() const { return uploaded; }
+    const ChunkFrame &chunkFrame() const { return frame; }
+
+    /* Fixes the frame of a quantized format, e.g. to the bounds of a tile ;
+       the next sync() re-encodes everything */
+    void setChunkFrame(const ChunkFrame &chunk)
+    {
+        frame = chunk;
+        frameSet = true;
+        uploaded = 0;
+    }
+
+private:
+    void fitFrame(const std::vector<Source> &vertices, size_t first);
+    void upload(const std::vector<Source> &vertices, size_t first, size_t last);
+    void bind() const;
+    void unbind() const;
+
+    GLuint buffer = 0;
+    size_t capacity = 0;
+    size_t uploaded = 0;
+    ChunkFrame frame;
+    bool frameSet = false;
+};
+
+/* Smallest storage allocated on the GPU, in vertices */
+static const size_t MIN_VERTEX_BUFFER_CAPACITY = 1024;
+
+template <class Format, class Source>
+void VertexBuffer<Format, Source>::fitFrame(const std::vector<Source> &vertices, size_t first)
+{
+    if (!Format::PositionType::QUANTIZED)
+    {
+        return;
+    }
+
+    if (!frameSet && first < vertices.size())
+    {
+        frame.originX = vertices[first].posX;
+        frame.originY = vertices[first].posY;
+        frameSet = true;
+    }
+
+    /* Double the chunk until every new vertex fits, then re-encode everything */
+    bool grown = false;
+    for (size_t i = first; i < vertices.size(); i++)
+    {
+        while (!frame.contains(vertices[i].posX, vertices[i].posY))
+        {
+            frame.halfExtent *= 2;
+            grown = true;
+        }
+    }
+    if (grown)
+    {
+        uploaded = 0;
+    }
+}
+
+template <class Format, class Source>
+void VertexBuffer<Format, Source>::upload(const std::vector<Source> &vertices, size_t first, size_t last)
+{
+    /* Only the range in flight is encoded on the CPU */
+    std::vector<Packed> staging(last - first);
+    for (size_t i = first; i < last; i++)
+    {
+        Format::encode(vertices[i], frame, staging[i - first]);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(Packed), staging.size() * sizeof(Packed), staging.data());
+}
+
+template <class Format, class Source>
+void VertexBuffer<Format, Source>::sync(const std::vector<Source> &vertices)
+{
+    if (vertices.size() < uploaded)
+    {
+        uploaded = 0;
+    }
+    if (vertices.size() == uploaded)
+    {
+        return;
+    }
+    fitFrame(vertices, uploaded);
+
+    if (!buffer)
+    {
+        glGenBuffers(1, &buffer);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+    if (vertices.size() > capacity)
+    {
+        /* Geometric growth keeps the number of full reallocations logarithmic */
+        size_t newCapacity = capacity ? capacity : MIN_VERTEX_BUFFER_CAPACITY;
+        while (newCapacity < vertices.size())
+        {
+            newCapacity *= 2;
+        }
+        capacity = newCapacity;
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Packed), nullptr, GL_DYNAMIC_DRAW);
+        uploaded = 0;
+    }
+
+    upload(vertices, uploaded, vertices.size());
+    uploaded = vertices.size();
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+template <class Format, class Source>
+void VertexBuffer<Format, Source>::update(const std::vector<Source> &vertices, size_t index)
+{
+    if (index >= uploaded)
+    {
+        sync(vertices);
+        return;
+    }
+
+    /* A vertex moved out of the quantized frame : everything is re-encoded */
+    if (Format::PositionType::QUANTIZED && !frame.contains(vertices[index].posX, vertices[index].posY))
+    {
+        fitFrame(vertices, index);
+        sync(vertices);
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    upload(vertices, index, index + 1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+template <class Format, class Source>
+void VertexBuffer<Format, Source>::bind() const
+{
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, Format::PositionType::GL_TYPE, sizeof(Packed), nullptr);
+    if (Format::HAS_COLOR)
+    {
+        glEnableClientState(GL_COLOR_ARRAY);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Packed), (void *)(2 * sizeof(typename Format::PositionType::Component)));
+    }
+
+    if (Format::PositionType::QUANTIZED)
+    {
+        /* Back from [-32767, 32767] to the chunk frame */
+        float scale = frame.halfExtent / Quantized16Position::STEPS;
+        glMatrixMode(GL_MODELVIEW);
+        glPushMatrix();
+        glTranslatef(frame.originX, frame.originY, 0);
+        glScalef(scale, scale, 1);
+    }
+}
+
+template <class Format, class Source>
+void VertexBuffer<Format, Source>::unbind() const
+{
+    if (Format::PositionType::QUANTIZED)
+    {
+        glPopMatrix();
+    }
+    if (Format::HAS_COLOR)
+    {
+        glDisableClientState(GL_COLOR_ARRAY);
+    }
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+template <class Format, class Source>
+void VertexBuffer<Format, Source>::draw(GLenum mode, size_t first, size_t count) const
+{
+    if (!count || first + count > uploaded)
+    {
+        return;
+    }
+    bind();
+    glDrawArrays(mode, GLint(first), GLsizei(count));
+    unbind();
+}
+
+template <class Format, class Source>
+void VertexBuffer<Format, Source>::draw(GLenum mode, const std::vector<VertexRange> &ranges) const
+{
+    std::vector<GLint> firsts;
+    std::vector<GLsizei> counts;
+    for (const VertexRange &range : ranges)
+    {
+        if (range.count && range.first + range.count <= uploaded)
+        {
+            firsts.push_back(GLint(range.first));
+            counts.push_back(GLsizei(range.count));
+        }
+    }
+    if (firsts.empty())
+    {
+        return;
+    }
+    bind();
+    glMultiDrawArrays(mode, firsts.data(), counts.data(), GLsizei(firsts.size()));
+    unbind();
+}
+
+template <class Format, class Source>
+void VertexBuffer<Format, Source>::draw(GLenum mode, const IndexBuffer &indices) const
+{
+    if (!uploaded || !indices.size())
+    {
+        return;
+    }
+    bind();
+    indices.drawElements(mode);
+    unbind();
+}
+
+template <class Format, class Source>
+void VertexBuffer<Format, Source>::release()
+{
+    if (buffer)
+    {
+        glDeleteBuffers(1, &buffer);
+    }
+    buffer = 0;
+    capacity = 0;
+    uploaded = 0;
+    frameSet = false;
+    frame = ChunkFrame();
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include "glad/glad.h"
+#include "render/Vertex.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/* GPU vertex layouts, picked at compile time :
+
+     VertexFormat<Float32Position>       8 bytes
+     VertexFormat<Float16Position>       4 bytes, ~3 significant digits
+     VertexFormat<Quantized16Position>   4 bytes, 1/32767 of the chunk extent
+
+   and the same with a packed RGBA8 color when the second parameter is true
+   (4 more bytes). Quantized positions are relative to a ChunkFrame, undone
+   by the modelview matrix at draw time. */
+
+/* Origin and half extent of the square a chunk of quantized vertices lives in */
+struct ChunkFrame
+{
+    float originX = 0;
+    float originY = 0;
+    float halfExtent = 1;
+
+    bool contains(float x, float y) const
+    {
+        return std::fabs(x - originX) <= halfExtent && std::fabs(y - originY) <= halfExtent;
+    }
+};
+
+struct Float32Position
+{
+    typedef float Component;
+    static const GLenum GL_TYPE = GL_FLOAT;
+    static const bool QUANTIZED = false;
+
+    static Component encode(float value, float, float) { return value; }
+};
+
+struct Float16Position
+{
+    typedef uint16_t Component;
+    static const GLenum GL_TYPE = GL_HALF_FLOAT;
+    static const bool QUANTIZED = false;
+
+    /* IEEE 754 binary16, rounded to nearest */
+    static Component encode(float value, float, float)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        uint32_t sign = (bits >> 16) & 0x8000;
+        int32_t exponent = int32_t((bits >> 23) & 0xff) - 127 + 15;
+        uint32_t mantissa = bits & 0x7fffff;
+
+        if (exponent >= 31)
+        {
+            /* Overflow, infinity and NaN */
+            return Component(sign | 0x7c00 | (((bits >> 23) & 0xff) == 0xff && mantissa ? 0x200 : 0));
+        }
+        if (exponent <= 0)
+        {
+            if (exponent < -10)
+            {
+                return Component(sign);
+            }
+            /* Subnormal */
+            mantissa |= 0x800000;
+            uint32_t shift = uint32_t(14 - exponent);
+            uint32_t half = mantissa >> shift;
+            uint32_t rest = mantissa & ((1u << shift) - 1);
+            uint32_t halfway = 1u << (shift - 1);
+            if (rest > halfway || (rest == halfway && (half & 1)))
+            {
+                half++;
+            }
+            return Component(sign | half);
+        }
+
+        uint32_t half = sign | (uint32_t(exponent) << 10) | (mantissa >> 13);
+        uint32_t rest = mantissa & 0x1fff;
+        if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+        {
+            /* May carry into the exponent, which still gives the right result */
+            half++;
+        }
+        return Component(half);
+    }
+};
+
+struct Quantized16Position
+{
+    typedef int16_t Component;
+    static const GLenum GL_TYPE = GL_SHORT;
+    static const bool QUANTIZED = true;
+    static const int STEPS = 32767;
+
+    static Component encode(float value, float origin, float halfExtent)
+    {
+        float normalized = (value - origin) / halfExtent;
+        normalized = normalized < -1 ? -1 : (normalized > 1 ? 1 : normalized);
+        return Component(std::lround(normalized * STEPS));
+    }
+};
+
+template <class Position, bool WithColor>
+struct PackedVertex;
+
+template <class Position>
+struct PackedVertex<Position, false>
+{
+    typename Position::Component pos[2];
+};
+
+template <class Position>
+struct PackedVertex<Position, true>
+{
+    typename Position::Component pos[2];
+    Rgba8 color;
+};
+
+template <class Position, bool WithColor = false>
+struct VertexFormat
+{
+    typedef Position PositionType;
+    typedef PackedVertex<Position, WithColor> Packed;
+    static const bool HAS_COLOR = WithColor;
+
+    template <class Source>
+    static void encode(const Source &source, const ChunkFrame &frame, Packed &out)
+    {
+        out.pos[0] = Position::encode(source.posX, frame.originX, frame.halfExtent);
+        out.pos[1] = Position::encode(source.posY, frame.originY, frame.halfExtent);
+        copyColor(source, out);
+    }
+
+private:
+    /* Only formats with a color read it from the source */
+    template <class Source>
+    static void copyColor(const Source &, PackedVertex<Position, false> &) {}
+    template <class Source>
+    static void copyColor(const Source &source, PackedVertex<Position, true> &out) { out.color = source.color; }
+};
+
+typedef VertexFormat<Float32Position> VertexF32;
+typedef VertexFormat<Float16Position> VertexF16;
+typedef VertexFormat<Quantized16Position> VertexQ16;
+typedef VertexFormat<Float32Position, true> ColoredVertexF32;
+typedef VertexFormat<Float16Position, true> ColoredVertexF16;
+typedef VertexFormat<Quantized16Position, true> ColoredVertexQ16;
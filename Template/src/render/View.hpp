@@ -0,0 +1,32 @@
+#pragma once
+#include "math/Bounds2.hpp"
+#include <algorithm>
+
+/* What the current projection shows : the world rectangle and its scale */
+struct View
+{
+    Bounds2 bounds;
+    float pixelsPerUnit = 1;
+};
+
+/* Same framing as onWindowResized() : the smallest side of the window spans
+   viewSize world units, centered on the origin */
+inline View orthoView(int width, int height, float viewSize)
+{
+    float aspectRatio = width / float(height);
+    float halfWidth = viewSize / 2;
+    float halfHeight = viewSize / 2;
+    if (aspectRatio > 1)
+    {
+        halfWidth *= aspectRatio;
+    }
+    else
+    {
+        halfHeight /= aspectRatio;
+    }
+
+    View view;
+    view.bounds = Bounds2::of(-halfWidth, -halfHeight, halfWidth, halfHeight);
+    view.pixelsPerUnit = std::min(width, height) / viewSize;
+    return view;
+}
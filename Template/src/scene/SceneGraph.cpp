@@ -0,0 +1,337 @@
+#include "scene/SceneGraph.hpp"
+#include "profiling/Profiler.hpp"
+#include <algorithm>
+
+NodeId SceneGraph::create(NodeId parent)
+{
+    NodeId id;
+    if (!freeList.empty())
+    {
+        id = freeList.back();
+        freeList.pop_back();
+        nodes[id] = SceneNode();
+    }
+    else
+    {
+        id = NodeId(nodes.size());
+        nodes.push_back(SceneNode());
+    }
+
+    SceneNode &created = nodes[id];
+    created.alive = true;
+    created.parent = parent;
+    if (parent == NO_NODE)
+    {
+        created.nextSibling = firstRoot;
+        firstRoot = id;
+    }
+    else
+    {
+        created.nextSibling = nodes[parent].firstChild;
+        nodes[parent].firstChild = id;
+    }
+    markDirty(id);
+    return id;
+}
+
+void SceneGraph::destroy(NodeId id)
+{
+    /* Unlink from the parent (or root) sibling list */
+    NodeId parent = nodes[id].parent;
+    NodeId *link = parent == NO_NODE ? &firstRoot : &nodes[parent].firstChild;
+    while (*link != id)
+    {
+        link = &nodes[*link].nextSibling;
+    }
+    *link = nodes[id].nextSibling;
+    if (parent != NO_NODE)
+    {
+        /* Its subtree bounds shrink */
+        markDirty(parent);
+    }
+
+    std::vector<NodeId> stack{id};
+    while (!stack.empty())
+    {
+        NodeId current = stack.back();
+        stack.pop_back();
+        for (NodeId child = nodes[current].firstChild; child != NO_NODE; child = nodes[child].nextSibling)
+        {
+            stack.push_back(child);
+        }
+        nodes[current].alive = false;
+        freeList.push_back(current);
+    }
+}
+
+void SceneGraph::markDirty(NodeId id)
+{
+    nodes[id].dirty = true;
+    nodes[id].subtreeDirty = true;
+    /* Flag the path to the root so update() can skip clean subtrees */
+    for (NodeId current = nodes[id].parent; current != NO_NODE && !nodes[current].subtreeDirty; current = nodes[current].parent)
+    {
+        nodes[current].subtreeDirty = true;
+    }
+}
+
+void SceneGraph::setTranslation(NodeId id, float x, float y)
+{
+    nodes[id].x = x;
+    nodes[id].y = y;
+    markDirty(id);
+}
+
+void SceneGraph::setRotation(NodeId id, float alpha)
+{
+    nodes[id].rotation = alpha;
+    markDirty(id);
+}
+
+void SceneGraph::setScale(NodeId id, float x, float y)
+{
+    nodes[id].scaleX = x;
+    nodes[id].scaleY = y;
+    markDirty(id);
+}
+
+void SceneGraph::setShape(NodeId id, ShapeKind shape, bool full, float r, float g, float b, float a)
+{
+    SceneNode &target = nodes[id];
+    target.hasShape = true;
+    target.shape = shape;
+    target.full = full;
+    target.color[0] = r;
+    target.color[1] = g;
+    target.color[2] = b;
+    target.color[3] = a;
+    /* The bounds depend on the shape */
+    markDirty(id);
+}
+
+bool SceneGraph::updateNode(NodeId id, const Affine2 &parentWorld, bool parentChanged)
+{
+    SceneNode &current = nodes[id];
+    if (!parentChanged && !current.dirty)
+    {
+        return false;
+    }
+    Affine2 local = Affine2::translation(current.x, current.y);
+    if (current.rotation != 0)
+    {
+        local = local * Affine2::rotation(current.rotation);
+    }
+    local = local * Affine2::scaling(current.scaleX, current.scaleY);
+    current.world = parentWorld * local;
+    current.bounds = current.hasShape ? transformBounds(current.world, shapeBounds(current.shape)) : Bounds2();
+    current.dirty = false;
+    return true;
+}
+
+size_t SceneGraph::updateSubtree(NodeId id, const Affine2 &parentWorld, bool parentChanged)
+{
+    bool changed = updateNode(id, parentWorld, parentChanged);
+    size_t updated = changed ? 1 : 0;
+    SceneNode &current = nodes[id];
+    current.subtreeDirty = false;
+
+    Bounds2 subtreeBounds = current.bounds;
+    for (NodeId child = current.firstChild; child != NO_NODE; child = nodes[child].nextSibling)
+    {
+        if (changed || nodes[child].subtreeDirty)
+        {
+            updated += updateSubtree(child, nodes[id].world, changed);
+        }
+        subtreeBounds.add(nodes[child].subtreeBounds);
+    }
+    nodes[id].subtreeBounds = subtreeBounds;
+    return updated;
+}
+
+void SceneGraph::update()
+{
+    lastUpdated = 0;
+    for (NodeId root = firstRoot; root != NO_NODE; root = nodes[root].nextSibling)
+    {
+        if (nodes[root].subtreeDirty)
+        {
+            lastUpdated += updateSubtree(root, Affine2::identity(), false);
+        }
+    }
+}
+
+template <class Visit>
+void SceneGraph::visitVisible(NodeId root, const Bounds2 &visible, std::vector<NodeId> &stack, Visit visit) const
+{
+    stack.push_back(root);
+    while (!stack.empty())
+    {
+        const SceneNode &current = nodes[stack.back()];
+        stack.pop_back();
+        if (!current.subtreeBounds.intersects(visible))
+        {
+            continue;
+        }
+
+        if (current.hasShape && current.bounds.intersects(visible))
+        {
+            visit(current);
+        }
+        for (NodeId child = current.firstChild; child != NO_NODE; child = nodes[child].nextSibling)
+        {
+            stack.push_back(child);
+        }
+    }
+}
+
+void SceneGraph::draw(InstancedRenderer &renderer, const Bounds2 &visible) const
+{
+    lastDrawn = 0;
+    std::vector<NodeId> stack;
+    for (NodeId root = firstRoot; root != NO_NODE; root = nodes[root].nextSibling)
+    {
+        visitVisible(root, visible, stack, [&](const SceneNode &node) {
+            renderer.add(node.shape, node.full, node.world, node.color[0], node.color[1], node.color[2], node.color[3]);
+            lastDrawn++;
+        });
+    }
+}
+
+/* Tasks per worker : subtrees differ in size, smaller tasks balance the load */
+static const unsigned TASKS_PER_WORKER = 4;
+/* Below this many nodes per task, waking the workers costs more than it saves */
+static const size_t MIN_NODES_PER_TASK = 256;
+
+void SceneGraph::recordSubtree(NodeId root, const InstancedRenderer &renderer, const Bounds2 &visible,
+                               DrawList &list, std::vector<NodeId> &stack, size_t &drawn) const
+{
+    visitVisible(root, visible, stack, [&](const SceneNode &node) {
+        renderer.record(list, node.shape, node.full, node.world, node.color[0], node.color[1], node.color[2], node.color[3]);
+        drawn++;
+    });
+}
+
+void SceneGraph::updateAndRecord(ThreadPool &workers, const InstancedRenderer &renderer, const Bounds2 &visible,
+                                 std::vector<DrawList> &lists)
+{
+    PROFILE_ZONE("SceneGraph::updateAndRecord");
+    size_t liveNodes = nodes.size() - freeList.size();
+    size_t tasks = std::min(size_t(workers.size() * TASKS_PER_WORKER), liveNodes / MIN_NODES_PER_TASK);
+    lists.resize(std::max(lists.size(), std::max(tasks, size_t(1))));
+    for (DrawList &list : lists)
+    {
+        list.clear();
+    }
+
+    std::vector<NodeId> stack;
+    if (tasks <= 1)
+    {
+        /* Small scene : the same work on this thread, into the first list */
+        update();
+        lastDrawn = 0;
+        for (NodeId root = firstRoot; root != NO_NODE; root = nodes[root].nextSibling)
+        {
+            recordSubtree(root, renderer, visible, lists[0], stack, lastDrawn);
+        }
+        return;
+    }
+
+    /* Split the tree level by level until there are enough subtrees : the
+       nodes above them are updated and recorded here, before the workers
+       start, so every subtree finds the world transform of its parent */
+    lastUpdated = 0;
+    lastDrawn = 0;
+    subtrees.clear();
+    splitNodes.clear();
+    for (NodeId root = firstRoot; root != NO_NODE; root = nodes[root].nextSibling)
+    {
+        subtrees.push_back(Subtree{root, false});
+    }
+    while (subtrees.size() < tasks)
+    {
+        nextSubtrees.clear();
+        for (const Subtree &subtree : subtrees)
+        {
+            SceneNode &node = nodes[subtree.root];
+            if (node.firstChild == NO_NODE)
+            {
+                nextSubtrees.push_back(subtree);
+                continue;
+            }
+            const Affine2 &parentWorld = node.parent == NO_NODE ? Affine2::identity() : nodes[node.parent].world;
+            bool changed = subtree.parentChanged || node.dirty;
+            if (updateNode(subtree.root, parentWorld, subtree.parentChanged))
+            {
+                lastUpdated++;
+            }
+            if (node.hasShape && node.bounds.intersects(visible))
+            {
+                renderer.record(lists[0], node.shape, node.full, node.world,
+                                node.color[0], node.color[1], node.color[2], node.color[3]);
+                lastDrawn++;
+            }
+            splitNodes.push_back(subtree.root);
+            for (NodeId child = node.firstChild; child != NO_NODE; child = nodes[child].nextSibling)
+            {
+                nextSubtrees.push_back(Subtree{child, changed});
+            }
+        }
+        bool grew = nextSubtrees.size() > subtrees.size();
+        subtrees.swap(nextSubtrees);
+        if (!grew)
+        {
+            /* Leaves and chains : splitting further would not help */
+            break;
+        }
+    }
+
+    tasks = std::min(tasks, subtrees.size());
+    taskUpdated.assign(tasks, 0);
+    taskDrawn.assign(tasks, 0);
+    for (size_t task = 0; task < tasks; task++)
+    {
+        /* Contiguous groups of subtrees, of (almost) equal size */
+        size_t first = subtrees.size() * task / tasks;
+        size_t last = subtrees.size() * (task + 1) / tasks;
+        workers.submit([this, task, first, last, &renderer, &visible, &lists]() {
+            PROFILE_ZONE("recordSubtrees");
+            /* Counted locally : tasks writing next to each other per node
+               would keep stealing the same cache line */
+            size_t updated = 0;
+            size_t drawn = 0;
+            std::vector<NodeId> stack;
+            for (size_t i = first; i < last; i++)
+            {
+                const Subtree &subtree = subtrees[i];
+                const SceneNode &node = nodes[subtree.root];
+                if (subtree.parentChanged || node.subtreeDirty)
+                {
+                    const Affine2 &parentWorld = node.parent == NO_NODE ? Affine2::identity() : nodes[node.parent].world;
+                    updated += updateSubtree(subtree.root, parentWorld, subtree.parentChanged);
+                }
+                recordSubtree(subtree.root, renderer, visible, lists[task], stack, drawn);
+            }
+            taskUpdated[task] = updated;
+            taskDrawn[task] = drawn;
+        });
+    }
+    workers.wait();
+
+    for (size_t task = 0; task < tasks; task++)
+    {
+        lastUpdated += taskUpdated[task];
+        lastDrawn += taskDrawn[task];
+    }
+    /* Bounds of the split nodes, children first */
+    for (size_t i = splitNodes.size(); i-- > 0;)
+    {
+        SceneNode &node = nodes[splitNodes[i]];
+        Bounds2 subtreeBounds = node.bounds;
+        for (NodeId child = node.firstChild; child != NO_NODE; child = nodes[child].nextSibling)
+        {
+            subtreeBounds.add(nodes[child].subtreeBounds);
+        }
+        node.subtreeBounds = subtreeBounds;
+        node.subtreeDirty = false;
+    }
+}
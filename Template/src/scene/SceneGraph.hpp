@@ -0,0 +1,117 @@
+#pragma once
+#include "math/Affine2.hpp"
+#include "math/Bounds2.hpp"
+#include "render/InstancedRenderer.hpp"
+#include "render/DrawList.hpp"
+#include "concurrency/ThreadPool.hpp"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+typedef uint32_t NodeId;
+static const NodeId NO_NODE = 0xffffffff;
+
+/* A node of the scene graph.
+   The local transform is applied like glTranslatef, glRotatef then glScalef. */
+struct SceneNode
+{
+    float x = 0;
+    float y = 0;
+    float rotation = 0;
+    float scaleX = 1;
+    float scaleY = 1;
+
+    /* parent world * local, valid after SceneGraph::update() */
+    Affine2 world = Affine2::identity();
+    /* World box of the shape (empty without one), and of the shapes of the
+       whole subtree, valid after SceneGraph::update() */
+    Bounds2 bounds;
+    Bounds2 subtreeBounds;
+
+    NodeId parent = NO_NODE;
+    NodeId firstChild = NO_NODE;
+    NodeId nextSibling = NO_NODE;
+
+    /* Local transform changed since the last update */
+    bool dirty = true;
+    /* This node or one of its descendants is dirty */
+    bool subtreeDirty = true;
+    bool alive = false;
+
+    bool hasShape = false;
+    ShapeKind shape = ShapeKind::Square;
+    bool full = false;
+    float color[4] = {1, 1, 1, 1};
+};
+
+/* Hierarchy of transforms replacing hand-written glPushMatrix/glPopMatrix blocks.
+   Nodes live contiguously in a pool and are addressed by index ; freed slots
+   are recycled. update() only walks the subtrees holding a dirty node, and
+   refreshes their bounds on the way back up for draw() to cull. Disjoint
+   subtrees share nothing, so updateAndRecord() handles them in parallel. */
+class SceneGraph
+{
+public:
+    NodeId create(NodeId parent = NO_NODE);
+
+    /* Frees the node and all its descendants */
+    void destroy(NodeId id);
+
+    const SceneNode &node(NodeId id) const { return nodes[id]; }
+
+    void setTranslation(NodeId id, float x, float y);
+    void setRotation(NodeId id, float alpha);
+    void setScale(NodeId id, float x, float y);
+    void setShape(NodeId id, ShapeKind shape, bool full, float r, float g, float b, float a = 1);
+
+    /* Recomputes the world transform of every node whose local transform, or
+       one of its ancestors', changed since the previous update */
+    void update();
+
+    /* Submits every node holding a shape that intersects `visible`, with its
+       world transform ; subtrees entirely outside are skipped */
+    void draw(InstancedRenderer &renderer, const Bounds2 &visible) const;
+
+    /* update() then draw() spread over `workers` : the tree is cut into
+       disjoint subtrees, below the roots if needed, and each task updates and
+       records a group of them into its own list of `lists` (resized as
+       needed, reuse it every frame). Scenes too small to be worth it are done
+       on the calling thread into lists[0]. Returns once every list is filled ;
+       the caller merges them into `renderer` on the GL thread. */
+    void updateAndRecord(ThreadPool &workers, const InstancedRenderer &renderer, const Bounds2 &visible,
+                         std::vector<DrawList> &lists);
+
+    /* Number of world transforms recomputed by the last update */
+    size_t updatedNodes() const { return lastUpdated; }
+    /* Number of shapes submitted by the last draw */
+    size_t drawnNodes() const { return lastDrawn; }
+
+private:
+    void markDirty(NodeId id);
+    /* World transform and box of one node, true if they were recomputed */
+    bool updateNode(NodeId id, const Affine2 &parentWorld, bool parentChanged);
+    /* Returns the number of world transforms recomputed */
+    size_t updateSubtree(NodeId id, const Affine2 &parentWorld, bool parentChanged);
+    void recordSubtree(NodeId root, const InstancedRenderer &renderer, const Bounds2 &visible,
+                       DrawList &list, std::vector<NodeId> &stack, size_t &drawn) const;
+    /* Calls visit(node) for every node with a shape of the subtree intersecting `visible` */
+    template <class Visit>
+    void visitVisible(NodeId root, const Bounds2 &visible, std::vector<NodeId> &stack, Visit visit) const;
+
+    std::vector<SceneNode> nodes;
+    std::vector<NodeId> freeList;
+    NodeId firstRoot = NO_NODE;
+    size_t lastUpdated = 0;
+    mutable size_t lastDrawn = 0;
+    /* Scratch of updateAndRecord() */
+    struct Subtree
+    {
+        NodeId root;
+        bool parentChanged;
+    };
+    std::vector<Subtree> subtrees;
+    std::vector<Subtree> nextSubtrees;
+    std::vector<NodeId> splitNodes;
+    std::vector<size_t> taskUpdated;
+    std::vector<size_t> taskDrawn;
+};
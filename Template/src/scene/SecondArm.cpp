@@ -0,0 +1,37 @@
+#include "scene/SecondArm.hpp"
+
+NodeId buildSecondArm(SceneGraph &scene, NodeId parent)
+{
+    NodeId arm = scene.create(parent);
+
+    /* The base is split in its parts to keep its immediate-mode colors : its
+       squares took the green left by drawOrigin(), its corners the orange
+       set by drawCircle(), which the bar and the tip then inherited */
+    NodeId base = scene.create(arm);
+    scene.setScale(base, 0.2f, 0.2f);
+    NodeId wide = scene.create(base);
+    scene.setScale(wide, 1.5f, 1);
+    scene.setShape(wide, ShapeKind::Square, 0, 0, 1, 0);
+    NodeId tall = scene.create(base);
+    scene.setScale(tall, 1, 1.5f);
+    scene.setShape(tall, ShapeKind::Square, 0, 0, 1, 0);
+    float dist = 0.75f / 2;
+    for (int corner = 0; corner < 4; corner++)
+    {
+        NodeId circle = scene.create(base);
+        scene.setTranslation(circle, corner & 1 ? dist : -dist, corner & 2 ? dist : -dist);
+        scene.setScale(circle, dist, dist);
+        scene.setShape(circle, ShapeKind::Circle, 0, 1, 0.5f, 0);
+    }
+
+    NodeId bar = scene.create(arm);
+    scene.setTranslation(bar, 0.1f, 0);
+    scene.setScale(bar, 1.5f, 0.2f);
+    scene.setShape(bar, ShapeKind::Square, 0, 1, 0.5f, 0);
+
+    NodeId tip = scene.create(arm);
+    scene.setTranslation(tip, 1.6f, 0);
+    scene.setScale(tip, 0.2f, 0.2f);
+    scene.setShape(tip, ShapeKind::RoundedSquare, 0, 1, 0.5f, 0);
+    return arm;
+}
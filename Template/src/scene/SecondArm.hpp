@@ -0,0 +1,7 @@
+#pragma once
+#include "scene/SceneGraph.hpp"
+
+/* Nodes of TD03's second arm : a rounded base, a bar and a rounded tip,
+   under a new node of `parent` that is returned. Shared by TD03_ex04 and
+   the bench so both draw the same scene. */
+NodeId buildSecondArm(SceneGraph &scene, NodeId parent = NO_NODE);
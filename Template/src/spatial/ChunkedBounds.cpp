@@ -0,0 +1,68 @@
+#include "spatial/ChunkedBounds.hpp"
+
+const size_t ChunkedBounds::CHUNK_SIZE;
+
+void ChunkedBounds::computeChunk(const std::vector<Vertex> &vertices, size_t chunk)
+{
+    Bounds2 bounds;
+    size_t last = std::min(vertices.size(), (chunk + 1) * CHUNK_SIZE);
+    for (size_t i = chunk * CHUNK_SIZE; i < last; i++)
+    {
+        bounds.add(vertices[i].posX, vertices[i].posY);
+    }
+    chunks[chunk] = bounds;
+}
+
+void ChunkedBounds::sync(const std::vector<Vertex> &vertices)
+{
+    if (vertices.size() < vertexCount)
+    {
+        vertexCount = 0;
+    }
+    if (vertices.size() == vertexCount)
+    {
+        return;
+    }
+
+    /* The last known chunk may have been partial */
+    size_t first = vertexCount / CHUNK_SIZE;
+    chunks.resize((vertices.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    for (size_t chunk = first; chunk < chunks.size(); chunk++)
+    {
+        computeChunk(vertices, chunk);
+    }
+    vertexCount = vertices.size();
+}
+
+void ChunkedBounds::update(const std::vector<Vertex> &vertices, size_t index)
+{
+    if (index >= vertexCount)
+    {
+        sync(vertices);
+        return;
+    }
+    /* The box may shrink : the whole chunk is scanned again */
+    computeChunk(vertices, index / CHUNK_SIZE);
+}
+
+void ChunkedBounds::visibleRanges(const Bounds2 &visible, std::vector<VertexRange> &ranges) const
+{
+    ranges.clear();
+    for (size_t chunk = 0; chunk < chunks.size(); chunk++)
+    {
+        if (!chunks[chunk].intersects(visible))
+        {
+            continue;
+        }
+        size_t first = chunk * CHUNK_SIZE;
+        size_t count = std::min(CHUNK_SIZE, vertexCount - first);
+        if (!ranges.empty() && ranges.back().first + ranges.back().count == first)
+        {
+            ranges.back().count += count;
+        }
+        else
+        {
+            ranges.push_back(VertexRange{first, count});
+        }
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "math/Bounds2.hpp"
+#include "render/Vertex.hpp"
+#include <vector>
+#include <cstddef>
+
+/* Bounding boxes of consecutive CHUNK_SIZE-vertex slices of a vertex array,
+   kept in sync like VertexBuffer : appending only touches the last chunks,
+   moving a vertex only its own. visibleRanges() lists the slices touching a
+   rectangle, so vertices far outside the view are never sent. CHUNK_SIZE is
+   a multiple of 2, 3 and 4 : no line, triangle or quad spans two chunks. */
+class ChunkedBounds
+{
+public:
+    /* Recomputes the chunks from the last one already known (everything if
+       the array shrank) */
+    void sync(const std::vector<Vertex> &vertices);
+
+    /* After vertices[index] was modified in place */
+    void update(const std::vector<Vertex> &vertices, size_t index);
+
+    /* Ranges of consecutive chunks intersecting `visible`, merged */
+    void visibleRanges(const Bounds2 &visible, std::vector<VertexRange> &ranges) const;
+
+    static const size_t CHUNK_SIZE = 1536;
+
+private:
+    void computeChunk(const std::vector<Vertex> &vertices, size_t chunk);
+
+    std::vector<Bounds2> chunks;
+    size_t vertexCount = 0;
+};
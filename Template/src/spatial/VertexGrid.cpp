@@ -0,0 +1,247 @@
+#include "spatial/VertexGrid.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+/* Average vertices per non-empty cell before the cells are split */
+static const size_t MAX_CELL_OCCUPANCY = 8;
+/* Below this many vertices a crowded grid is not worth rebuilding */
+static const size_t MIN_REBUILD_SIZE = 1024;
+
+VertexGrid::VertexGrid(float cellSize) : cellSize(cellSize), inverseCellSize(1 / cellSize)
+{
+    resetOccupied();
+}
+
+int VertexGrid::cellOf(float value) const
+{
+    return int(std::floor(value * inverseCellSize));
+}
+
+void VertexGrid::insert(float x, float y)
+{
+    uint32_t index = uint32_t(points.size());
+    points.push_back(Vertex{x, y});
+    cells[key(cellOf(x), cellOf(y))].push_back(index);
+    occupy(cellOf(x), cellOf(y));
+
+    if (points.size() >= std::max(rebuildAt, MIN_REBUILD_SIZE) && points.size() > MAX_CELL_OCCUPANCY * cells.size())
+    {
+        /* Identical points would split forever : the next attempt waits
+           until the vertex count doubled */
+        rebuildAt = points.size() * 2;
+        rebuild(cellSize / 2);
+    }
+}
+
+void VertexGrid::move(uint32_t index, float x, float y)
+{
+    Vertex &point = points[index];
+    CellKey from = key(cellOf(point.posX), cellOf(point.posY));
+    CellKey to = key(cellOf(x), cellOf(y));
+    point.posX = x;
+    point.posY = y;
+    if (from == to)
+    {
+        return;
+    }
+
+    std::vector<uint32_t> &source = cells[from];
+    source.erase(std::find(source.begin(), source.end(), index));
+    if (source.empty())
+    {
+        cells.erase(from);
+    }
+    cells[to].push_back(index);
+    occupy(cellOf(x), cellOf(y));
+}
+
+void VertexGrid::clear()
+{
+    points.clear();
+    cells.clear();
+    rebuildAt = 0;
+    resetOccupied();
+}
+
+void VertexGrid::resetOccupied()
+{
+    occupied[0] = occupied[1] = INT_MAX;
+    occupied[2] = occupied[3] = INT_MIN;
+}
+
+void VertexGrid::occupy(int cellX, int cellY)
+{
+    occupied[0] = std::min(occupied[0], cellX);
+    occupied[1] = std::min(occupied[1], cellY);
+    occupied[2] = std::max(occupied[2], cellX);
+    occupied[3] = std::max(occupied[3], cellY);
+}
+
+void VertexGrid::rebuild(float newCellSize)
+{
+    cellSize = newCellSize;
+    inverseCellSize = 1 / newCellSize;
+    cells.clear();
+    cells.reserve(points.size() / MAX_CELL_OCCUPANCY * 2);
+    resetOccupied();
+    for (uint32_t i = 0; i < points.size(); i++)
+    {
+        int cellX = cellOf(points[i].posX);
+        int cellY = cellOf(points[i].posY);
+        cells[key(cellX, cellY)].push_back(i);
+        occupy(cellX, cellY);
+    }
+}
+
+template <class Visitor>
+void VertexGrid::forEachCandidate(const Bounds2 &box, Visitor visit) const
+{
+    int minX = cellOf(box.minX);
+    int minY = cellOf(box.minY);
+    int maxX = cellOf(box.maxX);
+    int maxY = cellOf(box.maxY);
+
+    /* Large boxes : walking the stored cells is cheaper than the empty ones */
+    double boxCells = (double(maxX) - minX + 1) * (double(maxY) - minY + 1);
+    if (boxCells > double(cells.size()))
+    {
+        for (const auto &cell : cells)
+        {
+            for (uint32_t index : cell.second)
+            {
+                visit(index);
+            }
+        }
+        return;
+    }
+
+    for (int cellY = minY; cellY <= maxY; cellY++)
+    {
+        for (int cellX = minX; cellX <= maxX; cellX++)
+        {
+            auto cell = cells.find(key(cellX, cellY));
+            if (cell == cells.end())
+            {
+                continue;
+            }
+            for (uint32_t index : cell->second)
+            {
+                visit(index);
+            }
+        }
+    }
+}
+
+uint32_t VertexGrid::nearest(float x, float y, float maxDistance) const
+{
+    uint32_t best = NO_VERTEX;
+    float bestSquared = maxDistance * maxDistance;
+    auto consider = [&](uint32_t index) {
+        float dx = points[index].posX - x;
+        float dy = points[index].posY - y;
+        float squared = dx * dx + dy * dy;
+        if (squared <= bestSquared)
+        {
+            bestSquared = squared;
+            best = index;
+        }
+    };
+
+    if (cells.empty())
+    {
+        return NO_VERTEX;
+    }
+    size_t probed = 0;
+    auto probe = [&](int cellX, int cellY) {
+        probed++;
+        auto cell = cells.find(key(cellX, cellY));
+        if (cell != cells.end())
+        {
+            for (uint32_t index : cell->second)
+            {
+                consider(index);
+            }
+        }
+    };
+
+    int centerX = cellOf(x);
+    int centerY = cellOf(y);
+    /* Rings beyond the occupied cells are empty */
+    double reach = std::max(std::max(std::fabs(double(centerX) - occupied[0]), std::fabs(double(occupied[2]) - centerX)),
+                            std::max(std::fabs(double(centerY) - occupied[1]), std::fabs(double(occupied[3]) - centerY)));
+    int lastRing = int(std::min(std::ceil(double(maxDistance) * inverseCellSize), reach));
+
+    /* Ring k only holds vertices farther than (k - 1) cells, and is clipped
+       to the occupied cells. Dense data stops after a ring or two whatever
+       the radius ; only a search that already probed more cells than are
+       stored, without finding anything, walks the stored cells instead */
+    for (int ring = 0; ring <= lastRing; ring++)
+    {
+        float ringDistance = (ring - 1) * cellSize;
+        if (ring > 1 && ringDistance * ringDistance > bestSquared)
+        {
+            break;
+        }
+        if (best == NO_VERTEX && probed > cells.size())
+        {
+            for (const auto &cell : cells)
+            {
+                for (uint32_t index : cell.second)
+                {
+                    consider(index);
+                }
+            }
+            return best;
+        }
+
+        int firstRow = std::max(centerY - ring, occupied[1]);
+        int lastRow = std::min(centerY + ring, occupied[3]);
+        for (int cellY = firstRow; cellY <= lastRow; cellY++)
+        {
+            if (cellY == centerY - ring || cellY == centerY + ring)
+            {
+                int firstColumn = std::max(centerX - ring, occupied[0]);
+                int lastColumn = std::min(centerX + ring, occupied[2]);
+                for (int cellX = firstColumn; cellX <= lastColumn; cellX++)
+                {
+                    probe(cellX, cellY);
+                }
+                continue;
+            }
+            /* Inner rows of the ring only have their two end cells */
+            if (centerX - ring >= occupied[0])
+            {
+                probe(centerX - ring, cellY);
+            }
+            if (centerX + ring <= occupied[2])
+            {
+                probe(centerX + ring, cellY);
+            }
+        }
+    }
+    return best;
+}
+
+void VertexGrid::inRadius(float x, float y, float radius, std::vector<uint32_t> &out) const
+{
+    float radiusSquared = radius * radius;
+    forEachCandidate(Bounds2::of(x - radius, y - radius, x + radius, y + radius), [&](uint32_t index) {
+        float dx = points[index].posX - x;
+        float dy = points[index].posY - y;
+        if (dx * dx + dy * dy <= radiusSquared)
+        {
+            out.push_back(index);
+        }
+    });
+}
+
+void VertexGrid::inBox(const Bounds2 &box, std::vector<uint32_t> &out) const
+{
+    forEachCandidate(box, [&](uint32_t index) {
+        if (box.contains(points[index].posX, points[index].posY))
+        {
+            out.push_back(index);
+        }
+    });
+}
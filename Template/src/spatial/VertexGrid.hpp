@@ -0,0 +1,58 @@
+#pragma once
+#include "math/Bounds2.hpp"
+#include "render/Vertex.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/* Hashed uniform grid over a growing vertex array, for picking and snapping.
+
+   Vertices keep the index they were inserted with (the same as in vectex).
+   Only non-empty cells are stored, so the grid covers an unbounded plane ;
+   when cells get crowded the cell size is halved and the grid rebuilt, at
+   most once per doubling of the vertex count. nearest() searches rings of
+   cells around the query, clipped to the occupied cells, and stops as soon
+   as no farther ring can hold a closer vertex, so its cost depends on the
+   local density, not on size() or on the search radius. */
+class VertexGrid
+{
+public:
+    static const uint32_t NO_VERTEX = 0xffffffff;
+
+    explicit VertexGrid(float cellSize = 1.f / 16);
+
+    /* Adds a vertex with index size() */
+    void insert(float x, float y);
+    void move(uint32_t index, float x, float y);
+    void clear();
+
+    size_t size() const { return points.size(); }
+    const Vertex &vertex(uint32_t index) const { return points[index]; }
+
+    /* Closest vertex within maxDistance, NO_VERTEX if there is none */
+    uint32_t nearest(float x, float y, float maxDistance) const;
+    void inRadius(float x, float y, float radius, std::vector<uint32_t> &out) const;
+    void inBox(const Bounds2 &box, std::vector<uint32_t> &out) const;
+
+private:
+    typedef uint64_t CellKey;
+
+    int cellOf(float value) const;
+    static CellKey key(int cellX, int cellY) { return (uint64_t(uint32_t(cellX)) << 32) | uint32_t(cellY); }
+    void rebuild(float newCellSize);
+    void resetOccupied();
+    void occupy(int cellX, int cellY);
+
+    /* Calls visit(index) for every vertex of the cells overlapping the box */
+    template <class Visitor>
+    void forEachCandidate(const Bounds2 &box, Visitor visit) const;
+
+    std::vector<Vertex> points;
+    std::unordered_map<CellKey, std::vector<uint32_t>> cells;
+    float cellSize;
+    float inverseCellSize;
+    size_t rebuildAt = 0;
+    /* Cell range holding vertices (min x, min y, max x, max y) ; it only
+       grows between rebuilds, which is enough to clip the searches */
+    int occupied[4];
+};
@@ -0,0 +1,39 @@
+#include "assets/BakedTextures.hpp"
+#include "assets/Image.hpp"
+#include <iostream>
+
+/* Offline texture baking :
+     bake_assets OUTPUT IMAGE...
+   decodes every image, premultiplies its alpha, builds its full mip chain
+   and writes them all into OUTPUT (see BakedTextures.hpp). */
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage : " << argv[0] << " OUTPUT IMAGE..." << std::endl;
+        return 1;
+    }
+
+    BakedTexturesWriter writer;
+    for (int i = 2; i < argc; i++)
+    {
+        uint64_t hash = 0;
+        std::vector<Image> levels(1);
+        if (!hashFile(argv[i], hash) || !decodeImage(argv[i], levels[0]))
+        {
+            return 1;
+        }
+        premultiplyAlpha(levels[0]);
+        buildMipmaps(levels[0], levels);
+        writer.add(argv[i], hash, levels);
+        std::cout << argv[i] << " : " << levels[0].width << "x" << levels[0].height << ", "
+                  << levels.size() << " levels" << std::endl;
+    }
+
+    if (!writer.write(argv[1]))
+    {
+        return 1;
+    }
+    std::cout << "Baked " << argc - 2 << " textures into " << argv[1] << std::endl;
+    return 0;
+}